@@ -0,0 +1,366 @@
+#ifndef BATCH_JOBS_HPP
+#define BATCH_JOBS_HPP
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace tdzdd;
+
+// This class runs the jobs listed in a job file, in parallel when
+// OpenMP is enabled. Each graph is read and its frontiers are computed
+// only once however many jobs use it.
+//
+// Each line of a job file has the form
+//   <graph file> <kind> [<action> ...]
+// where kind is an option of the program without "--" (e.g. "cycle"),
+// and each action is one of
+//   s=<vertex name>   terminal s of paths (default: "1")
+//   t=<vertex name>   terminal t of paths (default: the number of vertices)
+//   size-dist         report the number of subgraphs of each size
+//   size-dist=<k>     same as size-dist but up to size k
+//   prob=<file>       report the probability with the edge probabilities
+//   dot=<file>        write the ZDD in the dot format to the file
+//   enum=<file>       write all the subgraphs to the file
+// Empty lines and lines beginning with '#' are ignored.
+//
+// For each job, one line of a JSON object is written as soon as the job
+// finishes, so the lines may not be in the order of the jobs.
+//
+// The jobs added by addPairJobs reduce their ZDDs and add them to one
+// DdForest, so that the subdiagrams common to several pairs are stored
+// only once. After them, the line {"forest":{"diagrams":<d>,"nodes":<n>}}
+// reports the size of the shared node table.
+class BatchJobs {
+private:
+    struct Job {
+        int line;
+        std::string graph_filename;
+        std::string kind;
+        std::string s;
+        std::string t;
+        bool size_dist;
+        int max_size;
+        std::string prob_filename;
+        std::string dot_filename;
+        std::string enum_filename;
+        bool shared;
+
+        Job() : line(0), size_dist(false), max_size(-1), shared(false) {
+        }
+    };
+
+    // a graph shared by jobs
+    struct GraphEntry {
+        tdzdd::Graph graph;
+        FrontierManager* fm;
+        std::string error;
+
+        GraphEntry() : fm(0) {
+        }
+
+        ~GraphEntry() {
+            delete fm;
+        }
+    };
+
+    std::vector<Job> jobs_;
+
+    static std::string jsonString(const std::string& s) {
+        std::ostringstream oss;
+        oss << '"';
+        for (size_t i = 0; i < s.size(); ++i) {
+            unsigned char c = s[i];
+            if (c == '"' || c == '\\') {
+                oss << '\\' << c;
+            } else if (c < 0x20) {
+                oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << static_cast<int>(c) << std::dec;
+            } else {
+                oss << c;
+            }
+        }
+        oss << '"';
+        return oss.str();
+    }
+
+    static Job parseJob(const std::string& line, int lineno) {
+        std::istringstream iss(line);
+        Job job;
+        job.line = lineno;
+        iss >> job.graph_filename >> job.kind;
+        if (!SubgraphKind::isKind(job.kind)) {
+            throw std::runtime_error("ERROR: line " + to_string(lineno) + ": "
+                                     + job.kind + ": No such kind of subgraphs");
+        }
+        std::string action;
+        while (iss >> action) {
+            std::string::size_type eq = action.find('=');
+            std::string key = action.substr(0, eq);
+            std::string value = (eq == std::string::npos) ? "" :
+                                action.substr(eq + 1);
+            if (key == "s" && !value.empty()) {
+                job.s = value;
+            } else if (key == "t" && !value.empty()) {
+                job.t = value;
+            } else if (key == "size-dist") {
+                job.size_dist = true;
+                job.max_size = value.empty() ? -1 : atoi(value.c_str());
+            } else if (key == "prob" && !value.empty()) {
+                job.prob_filename = value;
+            } else if (key == "dot" && !value.empty()) {
+                job.dot_filename = value;
+            } else if (key == "enum" && !value.empty()) {
+                job.enum_filename = value;
+            } else {
+                throw std::runtime_error("ERROR: line " + to_string(lineno)
+                                         + ": " + action + ": Unknown action");
+            }
+        }
+        return job;
+    }
+
+    static void loadGraph(const std::string& filename, GraphEntry& entry) {
+        try {
+            std::vector<int> plan;
+            if (GraphBinary::isGraphBinary(filename)) {
+                GraphBinary::read(filename, entry.graph, plan);
+            } else {
+                entry.graph.readEdges(filename);
+            }
+            entry.fm = plan.empty() ? new FrontierManager(entry.graph) :
+                       new FrontierManager(entry.graph, plan);
+        } catch (std::exception& e) {
+            entry.error = e.what();
+        }
+    }
+
+    // This function runs job and returns its result without braces.
+    // The ZDD of a shared job is added to forest.
+    static std::string runJob(const Job& job, const GraphEntry& entry,
+                              DdForest<2>& forest) {
+        const tdzdd::Graph& graph = entry.graph;
+        if (!entry.error.empty()) {
+            throw std::runtime_error(entry.error);
+        }
+
+        std::ostringstream oss;
+        int s = 0;
+        int t = 0;
+        if (SubgraphKind::hasTerminals(job.kind)) {
+            std::string s_name = job.s.empty() ? "1" : job.s;
+            std::string t_name = job.t.empty() ?
+                                 to_string(graph.vertexSize()) : job.t;
+            s = graph.getVertex(s_name);
+            t = graph.getVertex(t_name);
+            oss << "\"s\":" << jsonString(s_name)
+                << ",\"t\":" << jsonString(t_name) << ",";
+        }
+
+        double start = getWallClockTime();
+        DdStructure<2> dd;
+        SubgraphKind::construct(job.kind, graph, *entry.fm, s, t, dd);
+        double seconds = getWallClockTime() - start;
+
+        oss << "\"vertices\":" << graph.vertexSize()
+            << ",\"edges\":" << graph.edgeSize()
+            << ",\"nodes\":" << dd.size()
+            << ",\"solutions\":" << jsonString(dd.zddCardinality())
+            << ",\"seconds\":" << seconds;
+
+        if (job.shared) {
+            dd.zddReduce();
+            oss << ",\"reduced_nodes\":" << dd.size();
+#ifdef _OPENMP
+#pragma omp critical (forest)
+#endif
+            forest.add(dd);
+        }
+
+        if (job.size_dist) {
+            std::vector<std::string> dist = dd.zddSizeDistribution(job.max_size);
+            oss << ",\"size_dist\":[";
+            for (size_t k = 0; k < dist.size(); ++k) {
+                oss << (k == 0 ? "" : ",") << jsonString(dist[k]);
+            }
+            oss << "]";
+        }
+        if (!job.prob_filename.empty()) {
+            EdgeProbability ep(graph);
+            ep.readProbabilities(job.prob_filename);
+            double p = dd.evaluate(ZddProbability<double>(
+                ep.getLevelProbabilities<double>()));
+            ModularNumber<> pm = dd.evaluate(ZddProbability<ModularNumber<> >(
+                ep.getLevelProbabilities<ModularNumber<> >()));
+            oss << ",\"probability\":" << std::setprecision(17) << p
+                << ",\"probability_mod\":" << pm;
+        }
+        if (!job.dot_filename.empty()) {
+            std::ofstream fout(job.dot_filename.c_str());
+            if (!fout) {
+                throw std::runtime_error("ERROR: " + job.dot_filename
+                                         + ": Cannot open");
+            }
+            dd.dumpDot(fout);
+        }
+        if (!job.enum_filename.empty()) {
+            std::ofstream fout(job.enum_filename.c_str());
+            if (!fout) {
+                throw std::runtime_error("ERROR: " + job.enum_filename
+                                         + ": Cannot open");
+            }
+            EnumSubgraphs::enumSubgraphs(fout, graph, dd);
+        }
+        return oss.str();
+    }
+
+public:
+    BatchJobs() {
+    }
+
+    // This constructor reads the jobs from the file.
+    BatchJobs(const std::string& filename) {
+        std::ifstream fin(filename.c_str());
+        if (!fin) {
+            throw std::runtime_error("ERROR: " + filename + ": Cannot open");
+        }
+        std::string line;
+        for (int lineno = 1; std::getline(fin, line); ++lineno) {
+            std::string::size_type p = line.find_first_not_of(" \t\r");
+            if (p == std::string::npos || line[p] == '#') {
+                continue;
+            }
+            jobs_.push_back(parseJob(line, lineno));
+        }
+    }
+
+    // This function adds a job for each line "<s> <t>" of the file,
+    // which constructs the paths of the kind between s and t on the graph.
+    void addPairJobs(const std::string& graph_filename,
+                     const std::string& kind,
+                     const std::string& pairs_filename) {
+        if (!SubgraphKind::hasTerminals(kind)) {
+            throw std::runtime_error("ERROR: " + kind + " has no terminals");
+        }
+        std::ifstream fin(pairs_filename.c_str());
+        if (!fin) {
+            throw std::runtime_error("ERROR: " + pairs_filename
+                                     + ": Cannot open");
+        }
+        std::string line;
+        for (int lineno = 1; std::getline(fin, line); ++lineno) {
+            std::istringstream iss(line);
+            Job job;
+            if (!(iss >> job.s) || job.s[0] == '#') {
+                continue;
+            }
+            std::string rest;
+            if (!(iss >> job.t) || (iss >> rest)) {
+                throw std::runtime_error("ERROR: line " + to_string(lineno)
+                                         + ": Two vertices are expected");
+            }
+            job.line = lineno;
+            job.graph_filename = graph_filename;
+            job.kind = kind;
+            job.shared = true;
+            jobs_.push_back(job);
+        }
+    }
+
+    int size() const {
+        return static_cast<int>(jobs_.size());
+    }
+
+    // This function runs all the jobs and writes their results to os.
+    // It returns the number of failed jobs.
+    int run(std::ostream& os) const {
+        // messages from several threads would be mixed up
+        bool show = tdzdd::MessageHandler::showMessages(false);
+
+        std::map<std::string, int> graph_index;
+        std::vector<std::string> graph_filenames;
+        std::vector<int> job_graph(jobs_.size());
+        for (size_t i = 0; i < jobs_.size(); ++i) {
+            const std::string& f = jobs_[i].graph_filename;
+            if (graph_index.count(f) == 0) {
+                graph_index[f] = static_cast<int>(graph_filenames.size());
+                graph_filenames.push_back(f);
+            }
+            job_graph[i] = graph_index[f];
+        }
+
+        const int num_graphs = static_cast<int>(graph_filenames.size());
+        std::vector<GraphEntry*> entries(num_graphs);
+        for (int g = 0; g < num_graphs; ++g) {
+            entries[g] = new GraphEntry;
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int g = 0; g < num_graphs; ++g) {
+            loadGraph(graph_filenames[g], *entries[g]);
+        }
+
+        // the ZDDs of the shared jobs
+        DdForest<2> forest;
+        bool has_shared = false;
+        for (size_t i = 0; i < jobs_.size(); ++i) {
+            if (jobs_[i].shared) has_shared = true;
+        }
+
+        int failed = 0;
+        const int num_jobs = size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+:failed)
+#endif
+        for (int i = 0; i < num_jobs; ++i) {
+            const Job& job = jobs_[i];
+            std::string result;
+            try {
+                result = ",\"status\":\"ok\","
+                         + runJob(job, *entries[job_graph[i]], forest);
+            } catch (std::exception& e) {
+                result = ",\"status\":\"error\",\"message\":"
+                         + jsonString(e.what());
+                ++failed;
+            }
+
+            std::ostringstream oss;
+            oss << "{\"line\":" << job.line
+                << ",\"graph\":" << jsonString(job.graph_filename)
+                << ",\"kind\":" << jsonString(job.kind) << result << "}\n";
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            {
+                os << oss.str();
+                os.flush();
+            }
+        }
+
+        if (has_shared) {
+            os << "{\"forest\":{\"diagrams\":" << forest.numRoots()
+               << ",\"nodes\":" << forest.size() << "}}\n";
+            os.flush();
+        }
+
+        for (int g = 0; g < num_graphs; ++g) {
+            delete entries[g];
+        }
+        tdzdd::MessageHandler::showMessages(show);
+        return failed;
+    }
+};
+
+#endif // BATCH_JOBS_HPP
@@ -0,0 +1,118 @@
+#ifndef EDGE_PROBABILITY_HPP
+#define EDGE_PROBABILITY_HPP
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace tdzdd;
+
+// This class holds the probability that each edge is present.
+// The probabilities are read from a file in which each line has
+// the form "u v p", where u and v are the names of the endpoints
+// and p is given as a decimal such as "0.95" or a fraction such as "19/20".
+// Empty lines and lines beginning with '#' are ignored.
+// Every probability is kept as an exact fraction so that
+// it can be converted to both floating point and modular numbers.
+class EdgeProbability {
+private:
+    const tdzdd::Graph& graph_;
+
+    // numerators and denominators of the probabilities,
+    // indexed by edge numbers; a zero denominator means "not given"
+    std::vector<int64_t> num_;
+    std::vector<int64_t> den_;
+
+    static void parseProbability(const std::string& s,
+                                 int64_t& num, int64_t& den) {
+        num = 0;
+        den = 1;
+        size_t i = 0;
+        bool has_digit = false;
+
+        for (; i < s.size() && isdigit(s[i]); ++i) {
+            if (num > 100000000000000000LL) {
+                throw std::runtime_error("ERROR: Too many digits: " + s);
+            }
+            num = num * 10 + (s[i] - '0');
+            has_digit = true;
+        }
+        if (i < s.size() && s[i] == '.') {
+            for (++i; i < s.size() && isdigit(s[i]); ++i) {
+                if (den > 100000000000000000LL) {
+                    throw std::runtime_error("ERROR: Too many digits: " + s);
+                }
+                num = num * 10 + (s[i] - '0');
+                den *= 10;
+                has_digit = true;
+            }
+        } else if (i < s.size() && s[i] == '/') {
+            den = 0;
+            for (++i; i < s.size() && isdigit(s[i]); ++i) {
+                if (den > 100000000000000000LL) {
+                    throw std::runtime_error("ERROR: Too many digits: " + s);
+                }
+                den = den * 10 + (s[i] - '0');
+            }
+        }
+        if (!has_digit || i != s.size() || den == 0 || num > den) {
+            throw std::runtime_error("ERROR: Illegal probability: " + s);
+        }
+    }
+
+public:
+    EdgeProbability(const tdzdd::Graph& graph) : graph_(graph),
+        num_(graph.edgeSize(), 0), den_(graph.edgeSize(), 0) { }
+
+    void setProbability(int edge, int64_t num, int64_t den) {
+        num_[edge] = num;
+        den_[edge] = den;
+    }
+
+    void readProbabilities(const std::string& filename) {
+        std::ifstream fin(filename.c_str(), std::ios::in);
+        if (!fin) {
+            throw std::runtime_error("ERROR: Cannot open " + filename);
+        }
+
+        std::string line;
+        while (std::getline(fin, line)) {
+            std::istringstream iss(line);
+            std::string v1, v2, p, rest;
+            if (!(iss >> v1) || v1[0] == '#') {
+                continue;
+            }
+            if (!(iss >> v2 >> p) || (iss >> rest)) {
+                throw std::runtime_error("ERROR: Illegal line: " + line);
+            }
+            int64_t num, den;
+            parseProbability(p, num, den);
+            setProbability(graph_.getEdge(v1, v2), num, den);
+        }
+    }
+
+    // Returns the probabilities indexed by the levels of the ZDD,
+    // in which the edge e_i corresponds to level m - i.
+    template <typename T>
+    std::vector<T> getLevelProbabilities() const {
+        const int m = graph_.edgeSize();
+        std::vector<T> prob(m + 1);
+
+        for (int i = 0; i < m; ++i) {
+            if (den_[i] == 0) {
+                std::pair<std::string, std::string> name = graph_.edgeName(i);
+                throw std::runtime_error("ERROR: No probability for edge "
+                                         + name.first + "," + name.second);
+            }
+            prob[m - i] = T(num_[i]) / T(den_[i]);
+        }
+        return prob;
+    }
+};
+
+#endif // EDGE_PROBABILITY_HPP
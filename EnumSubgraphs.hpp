@@ -1,7 +1,13 @@
 #ifndef ENUM_SUBGRAPHS_HPP
 #define ENUM_SUBGRAPHS_HPP
 
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 class EnumSubgraphs {
 public:
@@ -19,6 +25,122 @@ public:
         enumColorfulSubgraphs<2>(os, graph, dd);
     }
 
+    // Enumerates the subgraphs in the same order and format as
+    // enumSubgraphs, saving the position to checkpoint_filename
+    // after every interval subgraphs and at the end.
+    // If resume_filename is not empty, the enumeration starts
+    // just after the position saved in it.
+    // A checkpoint file consists of the line "count <c>", where c is
+    // the number of subgraphs output so far, and the line
+    // "levels <l_1> <l_2> ...", which lists the levels (m - edge index)
+    // of the edges in the last subgraph output. The line "done" is
+    // added when the enumeration has finished.
+    static void enumSubgraphsWithCheckpoint(std::ostream& os,
+        const Graph& graph, const tdzdd::DdStructure<2>& dd,
+        const std::string& checkpoint_filename, uint64_t interval,
+        const std::string& resume_filename)
+    {
+        uint64_t count = 0;
+        std::set<int> levels;
+        bool done = false;
+        if (!resume_filename.empty()) {
+            readCheckpoint(resume_filename, count, levels, done);
+        }
+
+        tdzdd::DdStructure<2>::const_iterator itr =
+            (resume_filename.empty() || count == 0) ? dd.begin()
+            : done ? dd.end() : dd.find(levels);
+        if (!resume_filename.empty() && count > 0 && !done) {
+            if (itr == dd.end()) {
+                throw std::runtime_error("ERROR: " + resume_filename
+                                         + ": No such subgraph in the ZDD");
+            }
+            ++itr;
+        }
+
+        for (; itr != dd.end(); ++itr) {
+            levels = *itr;
+            for (int i = graph.edgeSize(); i >= 1; --i) {
+                os << (levels.count(i) > 0 ? "1" : "0");
+                if (i > 1) {
+                    os << " ";
+                }
+            }
+            os << "\n";
+            ++count;
+            if (!checkpoint_filename.empty() && interval > 0
+                && count % interval == 0) {
+                os.flush();
+                writeCheckpoint(checkpoint_filename, count, levels, false);
+            }
+        }
+
+        os.flush();
+        if (!checkpoint_filename.empty()) {
+            writeCheckpoint(checkpoint_filename, count, levels, true);
+        }
+    }
+
+    static void readCheckpoint(const std::string& filename,
+        uint64_t& count, std::set<int>& levels, bool& done)
+    {
+        std::ifstream fin(filename.c_str());
+        std::string line, key;
+        bool has_count = false;
+        bool has_levels = false;
+        levels.clear();
+        done = false;
+
+        while (std::getline(fin, line)) {
+            std::istringstream iss(line);
+            if (!(iss >> key)) {
+                continue;
+            }
+            if (key == "count") {
+                has_count = static_cast<bool>(iss >> count);
+            } else if (key == "levels") {
+                int level;
+                while (iss >> level) {
+                    levels.insert(level);
+                }
+                has_levels = true;
+            } else if (key == "done") {
+                done = true;
+            }
+        }
+        if (!has_count || !has_levels) {
+            throw std::runtime_error("ERROR: " + filename
+                                     + ": Illegal checkpoint file");
+        }
+    }
+
+    // The file is replaced atomically so that a crash during
+    // writing never destroys the previous checkpoint.
+    static void writeCheckpoint(const std::string& filename,
+        uint64_t count, const std::set<int>& levels, bool done)
+    {
+        const std::string tmp_filename = filename + ".tmp";
+        {
+            std::ofstream fout(tmp_filename.c_str());
+            fout << "count " << count << "\n";
+            fout << "levels";
+            for (std::set<int>::const_reverse_iterator itr = levels.rbegin();
+                 itr != levels.rend(); ++itr) {
+                fout << " " << *itr;
+            }
+            fout << "\n";
+            if (done) {
+                fout << "done\n";
+            }
+            if (!fout) {
+                throw std::runtime_error("ERROR: Cannot write " + tmp_filename);
+            }
+        }
+        if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+            throw std::runtime_error("ERROR: Cannot write " + filename);
+        }
+    }
+
 private:
     template <int ARITY>
     static void enumColorfulSubgraphs(NodeId node,
@@ -4,6 +4,8 @@
 #include <vector>
 #include <climits>
 
+#include "PruneCounter.hpp"
+
 #include "tdzdd/util/IntSubset.hpp"
 
 using namespace tdzdd;
@@ -26,7 +28,7 @@ private:
     // make subgraphs connected or not
     const bool is_connected_;
 
-    const FrontierManager fm_;
+    const FrontierPlan fm_;
 
     const int fixedDegStart_;
     const std::vector<IntSubset*> degRanges_;
@@ -35,34 +37,34 @@ private:
     // This function gets deg of v.
     int getDeg(FrontierDSData* data, int v) const {
         return static_cast<int>(data[is_connected_ ?
-                                    (fm_.vertexToPos(v) * 2) :
-                                    fm_.vertexToPos(v)]);
+                                    (fm_->vertexToPos(v) * 2) :
+                                    fm_->vertexToPos(v)]);
     }
 
     // This function sets deg of v to be d.
     void setDeg(FrontierDSData* data, int v, int d) const {
         data[is_connected_ ?
-            (fm_.vertexToPos(v) * 2) :
-            fm_.vertexToPos(v)] = static_cast<uchar>(d);
+            (fm_->vertexToPos(v) * 2) :
+            fm_->vertexToPos(v)] = static_cast<uchar>(d);
     }
 
     // This function gets comp of v.
     int getComp(FrontierDSData* data, int v, int index) const {
         assert(is_connected_);
-        return fm_.posToVertex(index, data[fm_.vertexToPos(v) * 2 + 1]);
+        return fm_->posToVertex(index, data[fm_->vertexToPos(v) * 2 + 1]);
     }
 
     // This function sets comp of v to be c.
     void setComp(FrontierDSData* data, int v, int c) const {
         assert(is_connected_);
-        data[fm_.vertexToPos(v) * 2 + 1] =
-            static_cast<uchar>(fm_.vertexToPos(c));
+        data[fm_->vertexToPos(v) * 2 + 1] =
+            static_cast<uchar>(fm_->vertexToPos(c));
     }
 
     // This function sets comp of v to be c.
     void clearComp(FrontierDSData* data, int v) const {
         assert(is_connected_);
-        data[fm_.vertexToPos(v) * 2 + 1] =
+        data[fm_->vertexToPos(v) * 2 + 1] =
             static_cast<uchar>(-1);
     }
 
@@ -115,14 +117,15 @@ private:
 public:
     FrontierDegreeDistributionSpec(const tdzdd::Graph& graph,
                                 const std::vector<IntSubset*>& degRanges,
-                                const bool is_connected)
+                                const bool is_connected,
+                                const FrontierManager* fm = NULL)
         : graph_(graph),
             n_(static_cast<short>(graph_.vertexSize())),
             m_(graph_.edgeSize()),
             is_connected_(is_connected),
-            fm_(graph_),
-            fixedDegStart_(is_connected ? (fm_.getMaxFrontierSize() * 2) :
-                                            fm_.getMaxFrontierSize()),
+            fm_(graph_, fm),
+            fixedDegStart_(is_connected ? (fm_->getMaxFrontierSize() * 2) :
+                                            fm_->getMaxFrontierSize()),
             degRanges_(degRanges),
             storingList_(getStoringList(degRanges))
     {
@@ -158,7 +161,7 @@ public:
         const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
 
         // initialize deg and comp of the vertices newly entering the frontier
-        const std::vector<int>& entering_vs = fm_.getEnteringVs(edge_index);
+        const std::vector<int>& entering_vs = fm_->getEnteringVs(edge_index);
         for (size_t i = 0; i < entering_vs.size(); ++i) {
             int v = entering_vs[i];
             // initially the value of deg is 0
@@ -170,17 +173,17 @@ public:
         }
 
         // vertices on the frontier
-        const std::vector<int>& frontier_vs = fm_.getFrontierVs(edge_index);
+        const std::vector<int>& frontier_vs = fm_->getFrontierVs(edge_index);
 
         if (value == 1) { // if we take the edge (go to 1-arc)
             // increment deg of v1 and v2 (recall that edge = {v1, v2})
 
             int upper = getDegUpper(data);
             if (getDeg(data, edge.v1) + 1 > upper) {
-                return 0;
+                return PRUNE("degree_distribution", "degree_overflow", level);
             }
             if (getDeg(data, edge.v2) + 1 > upper) {
-                return 0;
+                return PRUNE("degree_distribution", "degree_overflow", level);
             }
             if (edge.v1 >= FrontierDSData_MAX ||
                 edge.v2 >= FrontierDSData_MAX) {
@@ -209,13 +212,13 @@ public:
         }
 
         // vertices that are leaving the frontier
-        const std::vector<int>& leaving_vs = fm_.getLeavingVs(edge_index);
+        const std::vector<int>& leaving_vs = fm_->getLeavingVs(edge_index);
         for (size_t i = 0; i < leaving_vs.size(); ++i) {
             int v = leaving_vs[i];
 
             int d = getDeg(data, v);
             if (!checkFixedDegUpper(data, d)) {
-                return 0;
+                return PRUNE("degree_distribution", "degree_mismatch", level);
             }
             if (storingList_[d]) {
                 incrementFixedDeg(data, d);
@@ -269,12 +272,12 @@ public:
                         // that is, the generated subgraph is not connected.
                         // If so, we return the 0-terminal.
                         if (nonisolated_found) {
-                            return 0; // return the 0-terminal.
+                            return PRUNE("degree_distribution", "disconnected", level); // return the 0-terminal.
                         } else {
                             if (checkFixedDeg(data)) {
                                 return -1;
                             } else {
-                                return 0;
+                                return PRUNE("degree_distribution", "degree_mismatch", level);
                             }
                         }
                     }
@@ -290,12 +293,12 @@ public:
         if (level == 1) {
             if (is_connected_) {
                 // If we come here, the edge set is empty (taking no edge).
-                return 0;
+                return PRUNE("degree_distribution", "empty", level);
             } else {
                 if (checkFixedDeg(data)) {
                     return -1;
                 } else {
-                    return 0;
+                    return PRUNE("degree_distribution", "degree_mismatch", level);
                 }
             }
         }
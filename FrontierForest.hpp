@@ -4,6 +4,8 @@
 #include <vector>
 #include <climits>
 
+#include "PruneCounter.hpp"
+
 using namespace tdzdd;
 
 typedef unsigned short ushort;
@@ -20,37 +22,38 @@ private:
     // number of edges
     const int m_;
 
-    const FrontierManager fm_;
+    const FrontierPlan fm_;
 
     // This function gets comp of v.
     ushort getComp(FrontierForestData* data, short v) const {
-        return data[fm_.vertexToPos(v)];
+        return data[fm_->vertexToPos(v)];
     }
 
     // This function sets comp of v to be c.
     void setComp(FrontierForestData* data, short v, ushort c) const {
-        data[fm_.vertexToPos(v)] = c;
+        data[fm_->vertexToPos(v)] = c;
     }
 
     void initializeData(FrontierForestData* data) const {
-        for (int i = 0; i < fm_.getMaxFrontierSize(); ++i) {
+        for (int i = 0; i < fm_->getMaxFrontierSize(); ++i) {
             data[i] = 0;
         }
     }
 
 public:
-    FrontierForestSpec(const tdzdd::Graph& graph)
+    FrontierForestSpec(const tdzdd::Graph& graph,
+                       const FrontierManager* fm = NULL)
         : graph_(graph),
           n_(static_cast<short>(graph_.vertexSize())),
           m_(graph_.edgeSize()),
-          fm_(graph_)
+          fm_(graph_, fm)
     {
         if (n_ >= (1 << 16)) {
             std::cerr << "The number of vertices must be smaller than 2^15."
                       << std::endl;
             exit(1);
         }
-        setArraySize(fm_.getMaxFrontierSize());
+        setArraySize(fm_->getMaxFrontierSize());
     }
 
     int getRoot(FrontierForestData* data) const {
@@ -58,6 +61,17 @@ public:
         return m_;
     }
 
+    // This function returns whether the endpoints are in the same tree.
+    bool isForcedZero(const FrontierForestData* data, int level) const {
+        const int edge_index = m_ - level;
+        const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
+        if (fm_->isEntering(edge_index, edge.v1)
+            || fm_->isEntering(edge_index, edge.v2)) {
+            return false;
+        }
+        return data[fm_->vertexToPos(edge.v1)] == data[fm_->vertexToPos(edge.v2)];
+    }
+
     int getChild(FrontierForestData* data, int level, int value) const {
         assert(1 <= level && level <= m_);
 
@@ -68,7 +82,7 @@ public:
         const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
 
         // initialize deg and comp of the vertices newly entering the frontier
-        const std::vector<int>& entering_vs = fm_.getEnteringVs(edge_index);
+        const std::vector<int>& entering_vs = fm_->getEnteringVs(edge_index);
         for (size_t i = 0; i < entering_vs.size(); ++i) {
             int v = entering_vs[i];
             // initially the value of comp is the vertex number itself
@@ -76,14 +90,14 @@ public:
         }
 
         // vertices on the frontier
-        const std::vector<int>& frontier_vs = fm_.getFrontierVs(edge_index);
+        const std::vector<int>& frontier_vs = fm_->getFrontierVs(edge_index);
 
         if (value == 1) { // if we take the edge (go to 1-arc)
             ushort c1 = getComp(data, edge.v1);
             ushort c2 = getComp(data, edge.v2);
 
             if (c1 == c2) { // Any cycle must not occur.
-                return 0;
+                return PRUNE("forest", "cycle", level);
             }
 
             if (c1 != c2) { // connected components c1 and c2 become connected
@@ -101,7 +115,7 @@ public:
         }
 
         // vertices that are leaving the frontier
-        const std::vector<int>& leaving_vs = fm_.getLeavingVs(edge_index);
+        const std::vector<int>& leaving_vs = fm_->getLeavingVs(edge_index);
         for (size_t i = 0; i < leaving_vs.size(); ++i) {
             int v = leaving_vs[i];
 
@@ -1,6 +1,7 @@
 #ifndef __FRONTIER_MANAGER_HPP
 #define __FRONTIER_MANAGER_HPP
 
+#include <stdexcept>
 #include <vector>
 
 using namespace tdzdd;
@@ -33,7 +34,10 @@ private:
 
     // translate the vertex number to the position in the PodArray
     std::vector<int> vertex_to_pos_;
-    std::vector<std::vector<int> > pos_to_vertex_;
+    // pos_to_vertex_[i * max_frontier_size_ + pos] stores the vertex
+    // at pos when processing the i-th edge (positions never exceed
+    // the maximum frontier size because freed ones are reused first)
+    std::vector<int> pos_to_vertex_;
 
     // the maximum frontier size
     int max_frontier_size_;
@@ -46,34 +50,101 @@ private:
         leaving_vss_.resize(m);
 
         // compute entering_vss_
-        std::set<int> entered_vs;
+        std::vector<bool> entered_vs(n + 1);
         for (int i = 0; i < m; ++i) {
             const tdzdd::Graph::EdgeInfo& e = graph_.edgeInfo(i);
-            if (entered_vs.count(e.v1) == 0) {
+            if (!entered_vs[e.v1]) {
                 entering_vss_[i].push_back(e.v1);
-                entered_vs.insert(e.v1);
+                entered_vs[e.v1] = true;
             }
-            if (entered_vs.count(e.v2) == 0) {
+            if (!entered_vs[e.v2]) {
                 entering_vss_[i].push_back(e.v2);
-                entered_vs.insert(e.v2);
+                entered_vs[e.v2] = true;
             }
         }
-        assert(static_cast<int>(entered_vs.size()) == n);
 
         // compute leaving_vss_
-        std::set<int> left_vs;
+        std::vector<bool> left_vs(n + 1);
         for (int i = m - 1; i >= 0; --i) {
             const tdzdd::Graph::EdgeInfo& e = graph_.edgeInfo(i);
-            if (left_vs.count(e.v1) == 0) {
+            if (!left_vs[e.v1]) {
                 leaving_vss_[i].push_back(e.v1);
-                left_vs.insert(e.v1);
+                left_vs[e.v1] = true;
             }
-            if (left_vs.count(e.v2) == 0) {
+            if (!left_vs[e.v2]) {
                 leaving_vss_[i].push_back(e.v2);
-                left_vs.insert(e.v2);
+                left_vs[e.v2] = true;
             }
         }
-        assert(static_cast<int>(left_vs.size()) == n);
+    }
+
+    // fill pos_to_vertex_ from entering_vss_ and vertex_to_pos_
+    void constructPosToVertex() {
+        const int m = static_cast<int>(entering_vss_.size());
+        const int w = max_frontier_size_;
+
+        pos_to_vertex_.assign(static_cast<size_t>(m) * w, 0);
+        for (int i = 0; i < m; ++i) {
+            int* row = &pos_to_vertex_[0] + static_cast<size_t>(i) * w;
+            if (i > 0) {
+                std::copy(row - w, row, row);
+            }
+            const std::vector<int>& entering_vs = entering_vss_[i];
+            for (size_t j = 0; j < entering_vs.size(); ++j) {
+                int v = entering_vs[j];
+                row[vertex_to_pos_[v]] = v;
+            }
+        }
+    }
+
+    // append vss to plan as offsets followed by values
+    static void appendVss(std::vector<int>& plan,
+                          const std::vector<std::vector<int> >& vss) {
+        int offset = 0;
+        plan.push_back(offset);
+        for (size_t i = 0; i < vss.size(); ++i) {
+            offset += static_cast<int>(vss[i].size());
+            plan.push_back(offset);
+        }
+        for (size_t i = 0; i < vss.size(); ++i) {
+            plan.insert(plan.end(), vss[i].begin(), vss[i].end());
+        }
+    }
+
+    // read vss written by appendVss from plan[pos...]
+    static void readVss(const std::vector<int>& plan, size_t& pos, int m,
+                        int n, std::vector<std::vector<int> >& vss) {
+        checkPlanSize(plan, pos + m + 1);
+        const int* offsets = &plan[pos];
+        pos += m + 1;
+        if (offsets[0] != 0) {
+            throw std::runtime_error("ERROR: Broken frontier plan");
+        }
+        for (int i = 0; i < m; ++i) {
+            if (offsets[i] > offsets[i + 1]) {
+                throw std::runtime_error("ERROR: Broken frontier plan");
+            }
+        }
+        checkPlanSize(plan, pos + offsets[m]);
+        vss.resize(m);
+        for (int i = 0; i < m; ++i) {
+            vss[i].assign(plan.begin() + pos + offsets[i],
+                          plan.begin() + pos + offsets[i + 1]);
+        }
+        pos += offsets[m];
+        for (int i = 0; i < m; ++i) {
+            for (size_t j = 0; j < vss[i].size(); ++j) {
+                if (vss[i][j] < 1 || n < vss[i][j]) {
+                    throw std::runtime_error("ERROR: Broken frontier plan");
+                }
+            }
+        }
+    }
+
+    static void checkPlanSize(const std::vector<int>& plan, size_t size) {
+        if (plan.size() < size) {
+            throw std::runtime_error("ERROR: Broken frontier plan");
+        }
     }
 
     void construct() {
@@ -89,18 +160,9 @@ private:
         }
 
         vertex_to_pos_.resize(n + 1);
-        pos_to_vertex_.resize(m);
-        for (int i = 0; i < m; ++i) {
-            pos_to_vertex_[i].resize(n + 1);
-        }
 
         std::set<int> current_vs;
         for (int i = 0; i < m; ++i) {
-            if (i > 0) {
-                for (int j = 0; j < n + 1; ++j) {
-                    pos_to_vertex_[i][j] = pos_to_vertex_[i - 1][j];
-                }
-            }
             const std::vector<int>& entering_vs = entering_vss_[i];
             for (size_t j = 0; j < entering_vs.size(); ++j) {
                 int v = entering_vs[j];
@@ -108,7 +170,6 @@ private:
                 int u = unused.back();
                 unused.pop_back();
                 vertex_to_pos_[v] = u;
-                pos_to_vertex_[i][u] = v;
             }
 
             if (static_cast<int>(current_vs.size()) > max_frontier_size_) {
@@ -145,6 +206,8 @@ private:
                 unused.push_back(vertex_to_pos_[v]);
             }
         }
+
+        constructPosToVertex();
     }
 
 public:
@@ -152,6 +215,54 @@ public:
         construct();
     }
 
+    // This constructor restores the tables from a plan made by
+    // getPlan() for the same graph, without recomputing them.
+    FrontierManager(const tdzdd::Graph& graph, const std::vector<int>& plan)
+        : graph_(graph) {
+        const int n = graph_.vertexSize();
+        const int m = graph_.edgeSize();
+
+        checkPlanSize(plan, 3);
+        if (plan[0] != n || plan[1] != m || plan[2] < 0) {
+            throw std::runtime_error(
+                "ERROR: Frontier plan does not match the graph");
+        }
+        if (m > 0 && (plan[2] < 1 || n < plan[2])) {
+            throw std::runtime_error("ERROR: Broken frontier plan");
+        }
+        max_frontier_size_ = plan[2];
+
+        size_t pos = 3;
+        readVss(plan, pos, m, n, entering_vss_);
+        readVss(plan, pos, m, n, leaving_vss_);
+        readVss(plan, pos, m, n, frontier_vss_);
+        readVss(plan, pos, m, n, remaining_vss_);
+        checkPlanSize(plan, pos + n + 1);
+        vertex_to_pos_.assign(plan.begin() + pos, plan.begin() + pos + n + 1);
+        for (int v = 0; v <= n; ++v) {
+            if (vertex_to_pos_[v] < 0
+                || (v >= 1 && vertex_to_pos_[v] >= max_frontier_size_)) {
+                throw std::runtime_error("ERROR: Broken frontier plan");
+            }
+        }
+        constructPosToVertex();
+    }
+
+    // This function returns all the tables as a sequence of integers,
+    // from which the constructor above restores them.
+    std::vector<int> getPlan() const {
+        std::vector<int> plan;
+        plan.push_back(graph_.vertexSize());
+        plan.push_back(graph_.edgeSize());
+        plan.push_back(max_frontier_size_);
+        appendVss(plan, entering_vss_);
+        appendVss(plan, leaving_vss_);
+        appendVss(plan, frontier_vss_);
+        appendVss(plan, remaining_vss_);
+        plan.insert(plan.end(), vertex_to_pos_.begin(), vertex_to_pos_.end());
+        return plan;
+    }
+
     // This function returns the maximum frontier size.
     int getMaxFrontierSize() const {
         return max_frontier_size_;
@@ -163,6 +274,19 @@ public:
         return entering_vss_[index];
     }
 
+    // This function returns whether v newly enters the frontier
+    // when processing the (index)-th edge, in which case the data at
+    // the position of v is not initialized yet.
+    bool isEntering(int index, int v) const {
+        const std::vector<int>& vs = entering_vss_[index];
+        for (size_t i = 0; i < vs.size(); ++i) {
+            if (vs[i] == v) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     // This function returns the vector that stores the vertex numbers
     // that leave the frontier after the (index)-th edge is processed.
     const std::vector<int>& getLeavingVs(int index) const {
@@ -188,7 +312,8 @@ public:
     }
 
     int posToVertex(int index, int pos) const {
-        return pos_to_vertex_[index][pos];
+        return pos_to_vertex_[static_cast<size_t>(index) * max_frontier_size_
+                              + pos];
     }
 
     int getVerticesEnteringLevel(short v) const {
@@ -213,7 +338,7 @@ public:
         return -1;
     }
 
-    void print() {
+    void print() const {
         for (int i = 0; i < graph_.edgeSize(); ++i) {
             std::cout << "[";
             for (size_t j = 0; j < entering_vss_[i].size(); ++j) {
@@ -245,4 +370,37 @@ public:
     }
 };
 
+// This class holds the frontier plan of a spec. A plan given to the
+// constructor is only referred to, so it must outlive the spec. Otherwise
+// the plan is made from the graph and owned, and each copy of the spec
+// makes its own copy of it.
+class FrontierPlan {
+private:
+    const FrontierManager* fm_;
+    bool owned_;
+
+    FrontierPlan& operator=(const FrontierPlan&);
+
+public:
+    FrontierPlan(const tdzdd::Graph& graph, const FrontierManager* fm)
+        : fm_(fm != NULL ? fm : new FrontierManager(graph)),
+          owned_(fm == NULL) {}
+
+    FrontierPlan(const FrontierPlan& o)
+        : fm_(o.owned_ ? new FrontierManager(*o.fm_) : o.fm_),
+          owned_(o.owned_) {}
+
+    ~FrontierPlan() {
+        if (owned_) delete fm_;
+    }
+
+    const FrontierManager& operator*() const {
+        return *fm_;
+    }
+
+    const FrontierManager* operator->() const {
+        return fm_;
+    }
+};
+
 #endif // __FRONTIER_MANAGER_HPP
@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "PruneCounter.hpp"
+
 using namespace tdzdd;
 
 typedef unsigned char FrontierMatchingData;
@@ -21,7 +23,7 @@ private:
 
     const bool isComplete_;
 
-    const FrontierManager fm_;
+    const FrontierPlan fm_;
 
     bool getUsed(FrontierMatchingData* data, int v) const {
         return ((data[(v - 1) / 8] >> ((v - 1) % 8)) & 1u) != 0;
@@ -41,14 +43,23 @@ private:
         }
     }
 
+    // This function returns whether v is already matched
+    // before the (edge_index)-th edge is processed.
+    bool isUsed(const FrontierMatchingData* data, int edge_index, int v) const {
+        return !fm_->isEntering(edge_index, v)
+            && ((data[(v - 1) / 8] >> ((v - 1) % 8)) & 1u) != 0;
+    }
+
 public:
     FrontierMatchingSpec(const tdzdd::Graph& graph,
-                         bool isComplete) : graph_(graph),
+                         bool isComplete,
+                         const FrontierManager* fm = NULL)
+                                          : graph_(graph),
                                             n_(graph_.vertexSize()),
                                             m_(graph_.edgeSize()),
                                             dataSize_((n_ - 1) / 8 + 1),
                                             isComplete_(isComplete),
-                                            fm_(graph_)
+                                            fm_(graph_, fm)
     {
         setArraySize(dataSize_);
     }
@@ -58,6 +69,14 @@ public:
         return m_;
     }
 
+    // This function returns whether an endpoint is already matched.
+    bool isForcedZero(const FrontierMatchingData* data, int level) const {
+        const int edge_index = m_ - level;
+        const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
+        return isUsed(data, edge_index, edge.v1)
+            || isUsed(data, edge_index, edge.v2);
+    }
+
     int getChild(FrontierMatchingData* data, int level, int value) const {
         assert(1 <= level && level <= m_);
 
@@ -68,7 +87,7 @@ public:
         const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
 
         // initialize data of the vertices newly entering the frontier
-        const std::vector<int>& entering_vs = fm_.getEnteringVs(edge_index);
+        const std::vector<int>& entering_vs = fm_->getEnteringVs(edge_index);
         for (size_t i = 0; i < entering_vs.size(); ++i) {
             int v = entering_vs[i];
             resetUsed(data, v);
@@ -76,10 +95,10 @@ public:
 
         if (value == 1) { // if we take the edge (go to 1-arc)
             if (getUsed(data, edge.v1)) {
-                return 0;
+                return PRUNE("matching", "used", level);
             }
             if (getUsed(data, edge.v2)) {
-                return 0;
+                return PRUNE("matching", "used", level);
             }
             // increment deg of v1 and v2 (recall that edge = {v1, v2})
             setUsed(data, edge.v1);
@@ -87,13 +106,13 @@ public:
         }
 
         // vertices that are leaving the frontier
-        const std::vector<int>& leaving_vs = fm_.getLeavingVs(edge_index);
+        const std::vector<int>& leaving_vs = fm_->getLeavingVs(edge_index);
         for (size_t i = 0; i < leaving_vs.size(); ++i) {
             int v = leaving_vs[i];
 
             if (isComplete_) {
                 if (!getUsed(data, v)) {
-                    return 0;
+                    return PRUNE("matching", "unmatched", level);
                 }
             }
             // Since deg and comp of v are never used until the end,
@@ -4,6 +4,8 @@
 #include <vector>
 #include <climits>
 
+#include "PruneCounter.hpp"
+
 using namespace tdzdd;
 
 // data associated with each vertex on the frontier
@@ -26,22 +28,22 @@ private:
     const short s_;
     const short t_;
 
-    const FrontierManager fm_;
+    const FrontierPlan fm_;
 
     const int s_entered_level_;
     const int t_entered_level_;
     const int all_entered_level_;
 
     short getMate(FrontierMate* data, short v) const {
-        return data[fm_.vertexToPos(v)];
+        return data[fm_->vertexToPos(v)];
     }
 
     void setMate(FrontierMate* data, short v, short d) const {
-        data[fm_.vertexToPos(v)] = d;
+        data[fm_->vertexToPos(v)] = d;
     }
 
     void initializeMate(FrontierMate* data) const {
-        for (int i = 0; i < fm_.getMaxFrontierSize(); ++i) {
+        for (int i = 0; i < fm_->getMaxFrontierSize(); ++i) {
             data[i] = 0;
         }
     }
@@ -50,14 +52,15 @@ private:
         if (isCycle_) {
             return -1; // This value is never used.
         } else {
-            return m_ - fm_.getVerticesEnteringLevel(v);
+            return m_ - fm_->getVerticesEnteringLevel(v);
         }
     }
 
 public:
     // for cycles
     FrontierMateSpec(const tdzdd::Graph& graph,
-                     bool isHamiltonian)
+                     bool isHamiltonian,
+                     const FrontierManager* fm = NULL)
         : graph_(graph),
           n_(static_cast<short>(graph_.vertexSize())),
           m_(graph_.edgeSize()),
@@ -65,22 +68,23 @@ public:
           isHamiltonian_(isHamiltonian),
           s_(-1),
           t_(-1),
-          fm_(graph_),
+          fm_(graph_, fm),
           s_entered_level_(-1),
           t_entered_level_(-1),
-          all_entered_level_(m_ - fm_.getAllVerticesEnteringLevel())
+          all_entered_level_(m_ - fm_->getAllVerticesEnteringLevel())
     {
         if (graph_.vertexSize() > SHRT_MAX) { // SHRT_MAX == 32767
             std::cerr << "The number of vertices should be at most "
                       << SHRT_MAX << std::endl;
             exit(1);
         }
-        setArraySize(fm_.getMaxFrontierSize());
+        setArraySize(fm_->getMaxFrontierSize());
     }
 
     // for paths
     FrontierMateSpec(const tdzdd::Graph& graph,
-                     bool isHamiltonian, int s, int t)
+                     bool isHamiltonian, int s, int t,
+                     const FrontierManager* fm = NULL)
         : graph_(graph),
           n_(static_cast<short>(graph_.vertexSize())),
           m_(graph_.edgeSize()),
@@ -88,17 +92,17 @@ public:
           isHamiltonian_(isHamiltonian),
           s_(s),
           t_(t),
-          fm_(graph_),
+          fm_(graph_, fm),
           s_entered_level_(computeEnteredLevel(s)),
           t_entered_level_(computeEnteredLevel(t)),
-          all_entered_level_(m_ - fm_.getAllVerticesEnteringLevel())
+          all_entered_level_(m_ - fm_->getAllVerticesEnteringLevel())
     {
         if (graph_.vertexSize() > SHRT_MAX) { // SHRT_MAX == 32767
             std::cerr << "The number of vertices should be at most "
                       << SHRT_MAX << std::endl;
             exit(1);
         }
-        setArraySize(fm_.getMaxFrontierSize());
+        setArraySize(fm_->getMaxFrontierSize());
     }
 
     int getRoot(FrontierMate* data) const {
@@ -115,10 +119,10 @@ public:
         // The endpoints of "edge" are edge.v1 and edge.v2.
         const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
         // vertices on the frontier
-        const std::vector<int>& frontier_vs = fm_.getFrontierVs(edge_index);
+        const std::vector<int>& frontier_vs = fm_->getFrontierVs(edge_index);
 
         // initialize deg and comp of the vertices newly entering the frontier
-        const std::vector<int>& entering_vs = fm_.getEnteringVs(edge_index);
+        const std::vector<int>& entering_vs = fm_->getEnteringVs(edge_index);
         for (size_t i = 0; i < entering_vs.size(); ++i) {
             int v = entering_vs[i];
             setMate(data, v, v);
@@ -145,29 +149,29 @@ public:
 
         if (value == 1) { // if we take the edge (go to 1-arc)
             if (getMate(data, edge.v1) == 0 || getMate(data, edge.v2) == 0) {
-                return 0;
+                return PRUNE("mate", "degree_overflow", level);
             } else if (getMate(data, edge.v1) == edge.v2) {
                 if (!isCycle_ && level > s_entered_level_
                     && level > t_entered_level_) {
-                    return 0;
+                    return PRUNE("mate", "premature_close", level);
                 }
                 for (size_t i = 0; i < frontier_vs.size(); ++i) {
                     int v = frontier_vs[i];
                     if (v != edge.v1 && v != edge.v2) {
                         if (isHamiltonian_) {
                             if (getMate(data, v) != 0) {
-                                return 0;
+                                return PRUNE("mate", "disconnected", level);
                             }
                         } else {
                             if (getMate(data, v) != 0 && getMate(data, v) != v) {
-                                return 0;
+                                return PRUNE("mate", "disconnected", level);
                             }
                         }
                     }
                 }
                 if (isHamiltonian_) {
                     if (level > all_entered_level_) {
-                        return 0;
+                        return PRUNE("mate", "unvisited", level);
                     }
                 }
                 return -1; // return the 1-terminal
@@ -189,19 +193,19 @@ public:
         }
 
         // vertices that are leaving the frontier
-        const std::vector<int>& leaving_vs = fm_.getLeavingVs(edge_index);
+        const std::vector<int>& leaving_vs = fm_->getLeavingVs(edge_index);
         for (size_t i = 0; i < leaving_vs.size(); ++i) {
             int v = leaving_vs[i];
 
             if (isHamiltonian_) {
                 // The degree of v (!= s, t) must be 2.
                 if (getMate(data, v) != 0) {
-                    return 0;
+                    return PRUNE("mate", "leaving_degree", level);
                 }
             } else {
                 // The degree of v (!= s, t) must be 0 or 2.
                 if (getMate(data, v) != 0 && getMate(data, v) != v) {
-                    return 0;
+                    return PRUNE("mate", "leaving_degree", level);
                 }
             }
             // Since deg and comp of v are never used until the end,
@@ -210,7 +214,7 @@ public:
         }
         if (level == 1) {
             // If we come here, the edge set is empty (taking no edge).
-            return 0;
+            return PRUNE("mate", "empty", level);
         }
         assert(level - 1 > 0);
         return level - 1;
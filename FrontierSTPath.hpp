@@ -4,6 +4,8 @@
 #include <vector>
 #include <climits>
 
+#include "PruneCounter.hpp"
+
 using namespace tdzdd;
 
 // data associated with each vertex on the frontier
@@ -29,7 +31,7 @@ private:
     const short s_;
     const short t_;
 
-    const FrontierManager fm_;
+    const FrontierPlan fm_;
 
     const int s_entered_level_;
     const int t_entered_level_;
@@ -37,33 +39,33 @@ private:
 
     // This function gets deg of v.
     short getDeg(FrontierData2* data, short v) const {
-        return data[fm_.vertexToPos(v)].deg;
+        return data[fm_->vertexToPos(v)].deg;
     }
 
     // This function sets deg of v to be d.
     void setDeg(FrontierData2* data, short v, short d) const {
-        data[fm_.vertexToPos(v)].deg = d;
+        data[fm_->vertexToPos(v)].deg = d;
     }
 
     // This function gets comp of v.
     short getComp(FrontierData2* data, short v) const {
-        return data[fm_.vertexToPos(v)].comp;
+        return data[fm_->vertexToPos(v)].comp;
     }
 
     // This function sets comp of v to be c.
     void setComp(FrontierData2* data, short v, short c) const {
-        data[fm_.vertexToPos(v)].comp = c;
+        data[fm_->vertexToPos(v)].comp = c;
     }
 
     void initializeDegComp(FrontierData2* data) const {
-        for (int i = 0; i < fm_.getMaxFrontierSize(); ++i) {
+        for (int i = 0; i < fm_->getMaxFrontierSize(); ++i) {
             data[i].deg = 0;
             data[i].comp = 0;
         }
     }
 
     int computeEnteredLevel(short v) const {
-        return m_ - fm_.getVerticesEnteringLevel(v);
+        return m_ - fm_->getVerticesEnteringLevel(v);
     }
 
     int computeAllVEnteredLevel() const {
@@ -77,16 +79,24 @@ private:
         return min_level;
     }
 
+    // This function returns whether v already has the largest degree
+    // before the (edge_index)-th edge is processed.
+    bool isFull(const FrontierData2* data, int edge_index, int v) const {
+        return !fm_->isEntering(edge_index, v)
+            && data[fm_->vertexToPos(v)].deg >= (v == s_ || v == t_ ? 1 : 2);
+    }
+
 public:
     FrontierSTPathSpec(const tdzdd::Graph& graph,
-                       bool isHamiltonian, short s, short t)
+                       bool isHamiltonian, short s, short t,
+                       const FrontierManager* fm = NULL)
         : graph_(graph),
           n_(static_cast<short>(graph_.vertexSize())),
           m_(graph_.edgeSize()),
           isHamiltonian_(isHamiltonian),
           s_(s),
           t_(t),
-          fm_(graph_),
+          fm_(graph_, fm),
           s_entered_level_(computeEnteredLevel(s)),
           t_entered_level_(computeEnteredLevel(t)),
           all_v_entered_level_(computeAllVEnteredLevel())
@@ -96,7 +106,7 @@ public:
                       << SHRT_MAX << std::endl;
             exit(1);
         }
-        setArraySize(fm_.getMaxFrontierSize());
+        setArraySize(fm_->getMaxFrontierSize());
     }
 
     int getRoot(FrontierData2* data) const {
@@ -104,6 +114,14 @@ public:
         return m_;
     }
 
+    // This function returns whether an endpoint has degree 2 (1 if s or t).
+    bool isForcedZero(const FrontierData2* data, int level) const {
+        const int edge_index = m_ - level;
+        const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
+        return isFull(data, edge_index, edge.v1)
+            || isFull(data, edge_index, edge.v2);
+    }
+
     int getChild(FrontierData2* data, int level, int value) const {
         assert(1 <= level && level <= m_);
 
@@ -114,7 +132,7 @@ public:
         const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
 
         // initialize deg and comp of the vertices newly entering the frontier
-        const std::vector<int>& entering_vs = fm_.getEnteringVs(edge_index);
+        const std::vector<int>& entering_vs = fm_->getEnteringVs(edge_index);
         for (size_t i = 0; i < entering_vs.size(); ++i) {
             int v = entering_vs[i];
             // initially the value of deg is 0
@@ -124,7 +142,7 @@ public:
         }
 
         // vertices on the frontier
-        const std::vector<int>& frontier_vs = fm_.getFrontierVs(edge_index);
+        const std::vector<int>& frontier_vs = fm_->getFrontierVs(edge_index);
 
         if (value == 1) { // if we take the edge (go to 1-arc)
             // increment deg of v1 and v2 (recall that edge = {v1, v2})
@@ -148,25 +166,25 @@ public:
         }
 
         // vertices that are leaving the frontier
-        const std::vector<int>& leaving_vs = fm_.getLeavingVs(edge_index);
+        const std::vector<int>& leaving_vs = fm_->getLeavingVs(edge_index);
         for (size_t i = 0; i < leaving_vs.size(); ++i) {
             int v = leaving_vs[i];
 
             if (v == s_ || v == t_) {
                 // The degree of s and t must be 1.
                 if (getDeg(data, v) != 1) {
-                    return 0;
+                    return PRUNE("path", "terminal_degree", level);
                 }
             } else {
                 if (isHamiltonian_) {
                     // The degree of v (!= s, t) must be 2.
                     if (getDeg(data, v) != 2) {
-                        return 0;
+                        return PRUNE("path", "leaving_degree", level);
                     }
                 } else {
                     // The degree of v (!= s, t) must be 0 or 2.
                     if (getDeg(data, v) != 0 && getDeg(data, v) != 2) {
-                        return 0;
+                        return PRUNE("path", "leaving_degree", level);
                     }
                 }
             }
@@ -218,7 +236,7 @@ public:
                 // Then, we return the 0-terminal.
                 assert(getDeg(data, v) <= 2);
                 if (getDeg(data, v) > 0 && deg_found) {
-                    return 0; // return the 0-terminal.
+                    return PRUNE("path", "disconnected", level); // return the 0-terminal.
                 } else if (getDeg(data, v) > 0) { // If deg of v is 2,
                     // and there is no vertex whose deg is at least 1,
                     // a single cycle is completed.
@@ -226,14 +244,14 @@ public:
                     if (isHamiltonian_) {
                         if (frontier_exists
                             || level > all_v_entered_level_) {
-                            return 0;
+                            return PRUNE("path", "unvisited", level);
                         } else {
                             return -1; // return the 1-terminal
                         }
                     } else {
                         if (level > s_entered_level_
                             || level > t_entered_level_) {
-                            return 0;
+                            return PRUNE("path", "premature_close", level);
                         } else {
                             return -1; // return the 1-terminal
                         }
@@ -247,7 +265,7 @@ public:
         }
         if (level == 1) {
             // If we come here, the edge set is empty (taking no edge).
-            return 0;
+            return PRUNE("path", "empty", level);
         }
         assert(level - 1 > 0);
         return level - 1;
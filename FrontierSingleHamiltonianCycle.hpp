@@ -4,6 +4,8 @@
 #include <vector>
 #include <climits>
 
+#include "PruneCounter.hpp"
+
 using namespace tdzdd;
 
 // data associated with each vertex on the frontier
@@ -23,52 +25,60 @@ private:
     // number of edges
     const int m_;
 
-    const FrontierManager fm_;
+    const FrontierPlan fm_;
 
     // the level where all vertices enter the frontier
     const int all_entered_level_;
 
     // This function gets deg of v.
     short getDeg(FrontierDataForSHC* data, short v) const {
-        return data[fm_.vertexToPos(v)].deg;
+        return data[fm_->vertexToPos(v)].deg;
     }
 
     // This function sets deg of v to be d.
     void setDeg(FrontierDataForSHC* data, short v, short d) const {
-        data[fm_.vertexToPos(v)].deg = d;
+        data[fm_->vertexToPos(v)].deg = d;
     }
 
     // This function gets comp of v.
     short getComp(FrontierDataForSHC* data, short v) const {
-        return data[fm_.vertexToPos(v)].comp;
+        return data[fm_->vertexToPos(v)].comp;
     }
 
     // This function sets comp of v to be c.
     void setComp(FrontierDataForSHC* data, short v, short c) const {
-        data[fm_.vertexToPos(v)].comp = c;
+        data[fm_->vertexToPos(v)].comp = c;
     }
 
     void initializeDegComp(FrontierDataForSHC* data) const {
-        for (int i = 0; i < fm_.getMaxFrontierSize(); ++i) {
+        for (int i = 0; i < fm_->getMaxFrontierSize(); ++i) {
             data[i].deg = 0;
             data[i].comp = 0;
         }
     }
 
+    // This function returns whether v already has degree 2
+    // before the (edge_index)-th edge is processed.
+    bool isFull(const FrontierDataForSHC* data, int edge_index, int v) const {
+        return !fm_->isEntering(edge_index, v)
+            && data[fm_->vertexToPos(v)].deg >= 2;
+    }
+
 public:
-    FrontierSingleHamiltonianCycleSpec(const tdzdd::Graph& graph)
+    FrontierSingleHamiltonianCycleSpec(const tdzdd::Graph& graph,
+                                       const FrontierManager* fm = NULL)
         : graph_(graph),
           n_(static_cast<short>(graph_.vertexSize())),
           m_(graph_.edgeSize()),
-          fm_(graph_),
-          all_entered_level_(m_ - fm_.getAllVerticesEnteringLevel())
+          fm_(graph_, fm),
+          all_entered_level_(m_ - fm_->getAllVerticesEnteringLevel())
     {
         if (graph_.vertexSize() > SHRT_MAX) { // SHRT_MAX == 32767
             std::cerr << "The number of vertices should be at most "
                       << SHRT_MAX << std::endl;
             exit(1);
         }
-        setArraySize(fm_.getMaxFrontierSize());
+        setArraySize(fm_->getMaxFrontierSize());
     }
 
     int getRoot(FrontierDataForSHC* data) const {
@@ -76,6 +86,14 @@ public:
         return m_;
     }
 
+    // This function returns whether an endpoint has both its cycle edges.
+    bool isForcedZero(const FrontierDataForSHC* data, int level) const {
+        const int edge_index = m_ - level;
+        const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
+        return isFull(data, edge_index, edge.v1)
+            || isFull(data, edge_index, edge.v2);
+    }
+
     int getChild(FrontierDataForSHC* data, int level, int value) const {
         assert(1 <= level && level <= m_);
 
@@ -86,7 +104,7 @@ public:
         const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
 
         // initialize deg and comp of the vertices newly entering the frontier
-        const std::vector<int>& entering_vs = fm_.getEnteringVs(edge_index);
+        const std::vector<int>& entering_vs = fm_->getEnteringVs(edge_index);
         for (size_t i = 0; i < entering_vs.size(); ++i) {
             int v = entering_vs[i];
             // initially the value of deg is 0
@@ -96,7 +114,7 @@ public:
         }
 
         // vertices on the frontier
-        const std::vector<int>& frontier_vs = fm_.getFrontierVs(edge_index);
+        const std::vector<int>& frontier_vs = fm_->getFrontierVs(edge_index);
 
         if (value == 1) { // if we take the edge (go to 1-arc)
             // increment deg of v1 and v2 (recall that edge = {v1, v2})
@@ -120,13 +138,13 @@ public:
         }
 
         // vertices that are leaving the frontier
-        const std::vector<int>& leaving_vs = fm_.getLeavingVs(edge_index);
+        const std::vector<int>& leaving_vs = fm_->getLeavingVs(edge_index);
         for (size_t i = 0; i < leaving_vs.size(); ++i) {
             int v = leaving_vs[i];
 
             // The degree of v must be 2.
             if (getDeg(data, v) != 2) {
-                return 0;
+                return PRUNE("hamcycle", "leaving_degree", level);
             }
 
             bool samecomp_found = false;
@@ -178,14 +196,14 @@ public:
                 // is not connected.
                 // If so, we return the 0-terminal.
                 if (nonisolated_found) {
-                    return 0; // return the 0-terminal.
+                    return PRUNE("hamcycle", "disconnected", level); // return the 0-terminal.
                 } else {
                     // Here, a single Hamiltonian cycle is completed.
                     if (frontier_exists) {
-                        return 0; // return the 0-terminal
+                        return PRUNE("hamcycle", "unvisited", level); // return the 0-terminal
                     } else if (level > all_entered_level_) {
                         // Some vertices have not entered the frontier yet.
-                        return 0; // return the 0-terminal
+                        return PRUNE("hamcycle", "unvisited", level); // return the 0-terminal
                     } else {
                         return -1; // return the 1-terminal
                     }
@@ -198,7 +216,7 @@ public:
         }
         if (level == 1) {
             // If we come here, the edge set is empty (taking no edge).
-            return 0;
+            return PRUNE("hamcycle", "empty", level);
         }
         assert(level - 1 > 0);
         return level - 1;
@@ -4,6 +4,8 @@
 #include <vector>
 #include <climits>
 
+#include "PruneCounter.hpp"
+
 using namespace tdzdd;
 
 typedef unsigned short ushort;
@@ -22,54 +24,56 @@ private:
 
     const bool isSpanning_;
 
-    const FrontierManager fm_;
+    const FrontierPlan fm_;
 
     // This function gets whether the degree of v is at least 1 or not.
     bool getDeg(FrontierTreeData* data, short v) const {
-        return ((data[fm_.vertexToPos(v)] >> 15) & 1u) != 0;
+        return ((data[fm_->vertexToPos(v)] >> 15) & 1u) != 0;
     }
 
     // This function sets deg of v to be d.
     void setDeg(FrontierTreeData* data, short v) const {
-        data[fm_.vertexToPos(v)] |= (1u << 15);
+        data[fm_->vertexToPos(v)] |= (1u << 15);
     }
 
     // This function sets deg of v to be d.
     void resetDeg(FrontierTreeData* data, short v) const {
-        data[fm_.vertexToPos(v)] &= ~(1u << 15);
+        data[fm_->vertexToPos(v)] &= ~(1u << 15);
     }
 
     // This function gets comp of v.
     ushort getComp(FrontierTreeData* data, short v) const {
-        return data[fm_.vertexToPos(v)] & 0x7fffu;
+        return data[fm_->vertexToPos(v)] & 0x7fffu;
     }
 
     // This function sets comp of v to be c.
     void setComp(FrontierTreeData* data, short v, ushort c) const {
         assert(c < 0x8000u);
-        data[fm_.vertexToPos(v)] = (0x8000u & data[fm_.vertexToPos(v)]) | c;
+        data[fm_->vertexToPos(v)] = (0x8000u & data[fm_->vertexToPos(v)]) | c;
     }
 
     void initializeData(FrontierTreeData* data) const {
-        for (int i = 0; i < fm_.getMaxFrontierSize(); ++i) {
+        for (int i = 0; i < fm_->getMaxFrontierSize(); ++i) {
             data[i] = 0;
         }
     }
 
 public:
     FrontierTreeSpec(const tdzdd::Graph& graph,
-                     bool isSpanning) : graph_(graph),
+                     bool isSpanning,
+                     const FrontierManager* fm = NULL)
+                                      : graph_(graph),
                                         n_(graph_.vertexSize()),
                                         m_(graph_.edgeSize()),
                                         isSpanning_(isSpanning),
-                                        fm_(graph_)
+                                        fm_(graph_, fm)
     {
         if (n_ >= (1 << 15)) {
             std::cerr << "The number of vertices must be smaller than 2^15."
                       << std::endl;
             exit(1);
         }
-        setArraySize(fm_.getMaxFrontierSize());
+        setArraySize(fm_->getMaxFrontierSize());
     }
 
     int getRoot(FrontierTreeData* data) const {
@@ -77,6 +81,18 @@ public:
         return m_;
     }
 
+    // This function returns whether the endpoints are already connected.
+    bool isForcedZero(const FrontierTreeData* data, int level) const {
+        const int edge_index = m_ - level;
+        const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
+        if (fm_->isEntering(edge_index, edge.v1)
+            || fm_->isEntering(edge_index, edge.v2)) {
+            return false;
+        }
+        return (data[fm_->vertexToPos(edge.v1)] & 0x7fffu)
+            == (data[fm_->vertexToPos(edge.v2)] & 0x7fffu);
+    }
+
     int getChild(FrontierTreeData* data, int level, int value) const {
         assert(1 <= level && level <= m_);
 
@@ -87,7 +103,7 @@ public:
         const Graph::EdgeInfo& edge = graph_.edgeInfo(edge_index);
 
         // initialize deg and comp of the vertices newly entering the frontier
-        const std::vector<int>& entering_vs = fm_.getEnteringVs(edge_index);
+        const std::vector<int>& entering_vs = fm_->getEnteringVs(edge_index);
         for (size_t i = 0; i < entering_vs.size(); ++i) {
             int v = entering_vs[i];
             // initially the value of comp is the vertex number itself
@@ -95,14 +111,14 @@ public:
         }
 
         // vertices on the frontier
-        const std::vector<int>& frontier_vs = fm_.getFrontierVs(edge_index);
+        const std::vector<int>& frontier_vs = fm_->getFrontierVs(edge_index);
 
         if (value == 1) { // if we take the edge (go to 1-arc)
             ushort c1 = getComp(data, edge.v1);
             ushort c2 = getComp(data, edge.v2);
 
             if (c1 == c2) { // Any cycle must not occur.
-                return 0;
+                return PRUNE("tree", "cycle", level);
             }
 
             // increment deg of v1 and v2 (recall that edge = {v1, v2})
@@ -124,13 +140,13 @@ public:
         }
 
         // vertices that are leaving the frontier
-        const std::vector<int>& leaving_vs = fm_.getLeavingVs(edge_index);
+        const std::vector<int>& leaving_vs = fm_->getLeavingVs(edge_index);
         for (size_t i = 0; i < leaving_vs.size(); ++i) {
             int v = leaving_vs[i];
 
             if (isSpanning_) {
                 if (!getDeg(data, v)) { // the degree of v must be at least 1
-                    return 0;
+                    return PRUNE("tree", "not_spanning", level);
                 }
             }
 
@@ -187,7 +203,7 @@ public:
                 // Then, we return the 0-terminal.
                 //assert(getDeg(data, v) == 0 || getDeg(data, v) == 2);
                 if (getDeg(data, v) && deg_found) {
-                    return 0; // return the 0-terminal.
+                    return PRUNE("tree", "disconnected", level); // return the 0-terminal.
                 } else if (getDeg(data, v)) { // If deg of v is 2,
                     // and there is no vertex whose deg is at least 1
                     // a single cycle is completed.
@@ -195,7 +211,7 @@ public:
 
                     if (isSpanning_) {
                         if (frontier_exists) {
-                            return 0;
+                            return PRUNE("tree", "not_spanning", level);
                         } else {
                             return -1; // return the 1-terminal
                         }
@@ -212,7 +228,7 @@ public:
         }
         if (level == 1) {
             // If we come here, the edge set is empty (taking no edge).
-            return 0;
+            return PRUNE("tree", "empty", level);
         }
 
         assert(level - 1 > 0);
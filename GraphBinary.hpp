@@ -0,0 +1,270 @@
+#ifndef GRAPH_BINARY_HPP
+#define GRAPH_BINARY_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace tdzdd;
+
+// This class reads and writes a graph in a binary container that holds
+// the vertex names in vertex-number order, the edges in processing order,
+// the vertex colors and the frontier plan made by FrontierManager.
+// Loading a container maps the file once and skips both the renumbering
+// in Graph::update() and the construction of the frontier tables.
+//
+// Layout (native byte order, every field 4-byte aligned):
+//   char[8]  magic "FBGRAPH\0"
+//   int32    version, byte order mark 0x01020304
+//   int32    n (# of vertices), m (# of edges), plan size in int32
+//   int32    name offsets [n + 1], followed by the name characters
+//   int32    color offsets [n + 1], followed by the color characters
+//   int32    edges [2 * m], as vertex numbers
+//   int32    plan [plan size]
+class GraphBinary {
+private:
+    static const int VERSION = 1;
+    static const int32_t BYTE_ORDER_MARK = 0x01020304;
+
+    static const char* magic() {
+        return "FBGRAPH";
+    }
+
+    // sequential reader over the mapped file
+    class Reader {
+    private:
+        const char* p_;
+        const char* end_;
+
+    public:
+        Reader(const char* p, size_t size) : p_(p), end_(p + size) {
+        }
+
+        // returns size bytes and skips them with the padding
+        const char* take(size_t size) {
+            const size_t padded = (size + 3) / 4 * 4;
+            if (static_cast<size_t>(end_ - p_) < padded) {
+                throw std::runtime_error("ERROR: Truncated graph binary");
+            }
+            const char* p = p_;
+            p_ += padded;
+            return p;
+        }
+
+        int32_t getInt() {
+            int32_t x;
+            std::memcpy(&x, take(sizeof(x)), sizeof(x));
+            return x;
+        }
+
+        void getInts(std::vector<int32_t>& v, size_t count) {
+            v.resize(count);
+            if (count > 0) {
+                std::memcpy(&v[0], take(count * sizeof(int32_t)),
+                            count * sizeof(int32_t));
+            }
+        }
+    };
+
+    static void putInt(std::ostream& os, int32_t x) {
+        os.write(reinterpret_cast<const char*>(&x), sizeof(x));
+    }
+
+    static void putInts(std::ostream& os, const std::vector<int32_t>& v) {
+        if (!v.empty()) {
+            os.write(reinterpret_cast<const char*>(&v[0]),
+                     v.size() * sizeof(int32_t));
+        }
+    }
+
+    static void putChars(std::ostream& os, const std::string& s) {
+        os.write(s.data(), s.size());
+        for (size_t i = s.size(); i % 4 != 0; ++i) {
+            os.put('\0');
+        }
+    }
+
+    // write strings[1..n] as offsets followed by the characters
+    static void putStrings(std::ostream& os,
+                           const std::vector<std::string>& strings) {
+        std::vector<int32_t> offsets(1, 0);
+        std::string chars;
+        for (size_t i = 1; i < strings.size(); ++i) {
+            chars += strings[i];
+            offsets.push_back(static_cast<int32_t>(chars.size()));
+        }
+        putInts(os, offsets);
+        putChars(os, chars);
+    }
+
+    static void getStrings(Reader& reader, int n, std::vector<int32_t>& offsets,
+                           const char*& chars) {
+        reader.getInts(offsets, n + 1);
+        if (offsets[0] != 0) {
+            throw std::runtime_error("ERROR: Broken graph binary");
+        }
+        for (int i = 0; i < n; ++i) {
+            if (offsets[i] > offsets[i + 1]) {
+                throw std::runtime_error("ERROR: Broken graph binary");
+            }
+        }
+        chars = reader.take(offsets[n]);
+    }
+
+    static void load(const char* data, size_t size, tdzdd::Graph& graph,
+                     std::vector<int>& plan) {
+        Reader reader(data, size);
+        if (std::memcmp(reader.take(8), magic(), 8) != 0) {
+            throw std::runtime_error("ERROR: Not a graph binary");
+        }
+        if (reader.getInt() != VERSION) {
+            throw std::runtime_error("ERROR: Unsupported graph binary version");
+        }
+        if (reader.getInt() != BYTE_ORDER_MARK) {
+            throw std::runtime_error("ERROR: Graph binary has another byte order");
+        }
+        const int n = reader.getInt();
+        const int m = reader.getInt();
+        const int plan_size = reader.getInt();
+        if (n < 0 || m < 0 || plan_size < 0) {
+            throw std::runtime_error("ERROR: Broken graph binary");
+        }
+
+        std::vector<int32_t> name_offsets;
+        const char* name_chars;
+        getStrings(reader, n, name_offsets, name_chars);
+        std::vector<int32_t> color_offsets;
+        const char* color_chars;
+        getStrings(reader, n, color_offsets, color_chars);
+
+        tdzdd::NameTable names;
+        for (int i = 0; i < n; ++i) {
+            size_t len = name_offsets[i + 1] - name_offsets[i];
+            if (names.intern(name_chars + name_offsets[i], len) != i) {
+                throw std::runtime_error("ERROR: Duplicated vertex name");
+            }
+        }
+        std::vector<int32_t> edge_ints;
+        reader.getInts(edge_ints, 2 * static_cast<size_t>(m));
+        std::vector<tdzdd::Graph::VertexNumberPair> edges(m);
+        for (int i = 0; i < m; ++i) {
+            edges[i].first = edge_ints[2 * i];
+            edges[i].second = edge_ints[2 * i + 1];
+        }
+        reader.getInts(plan, plan_size);
+
+        // start from an empty graph, since clearColors() reads the
+        // number of vertices of the old one
+        graph = tdzdd::Graph();
+        for (int i = 0; i < n; ++i) {
+            if (color_offsets[i] < color_offsets[i + 1]) {
+                graph.setColor(names.name(i),
+                               std::string(color_chars + color_offsets[i],
+                                           color_chars + color_offsets[i + 1]));
+            }
+        }
+        graph.assignNumbered(names, edges);
+    }
+
+public:
+    // This function checks whether the file starts with the magic number.
+    static bool isGraphBinary(const std::string& filename) {
+        std::ifstream fin(filename.c_str(), std::ios::in | std::ios::binary);
+        char buf[8];
+        return fin.read(buf, 8) && std::memcmp(buf, magic(), 8) == 0;
+    }
+
+    // This function writes graph and the plan of fm to the file.
+    static void write(const std::string& filename, const tdzdd::Graph& graph,
+                      const FrontierManager& fm) {
+        const int n = graph.vertexSize();
+        const int m = graph.edgeSize();
+        const std::vector<int> plan = fm.getPlan();
+
+        std::vector<std::string> names(n + 1);
+        std::vector<std::string> colors(n + 1);
+        for (int v = 1; v <= n; ++v) {
+            names[v] = graph.vertexName(v);
+            colors[v] = graph.vertexColor(v);
+        }
+        std::vector<int32_t> edges;
+        edges.reserve(2 * static_cast<size_t>(m));
+        for (int e = 0; e < m; ++e) {
+            std::pair<std::string, std::string> name = graph.edgeName(e);
+            edges.push_back(graph.getVertex(name.first));
+            edges.push_back(graph.getVertex(name.second));
+        }
+
+        std::ofstream fout(filename.c_str(),
+                           std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!fout) throw std::runtime_error(strerror(errno));
+        fout.write(magic(), 8);
+        putInt(fout, VERSION);
+        putInt(fout, BYTE_ORDER_MARK);
+        putInt(fout, n);
+        putInt(fout, m);
+        putInt(fout, static_cast<int32_t>(plan.size()));
+        putStrings(fout, names);
+        putStrings(fout, colors);
+        putInts(fout, edges);
+        putInts(fout, plan);
+        fout.close();
+        if (!fout) throw std::runtime_error(strerror(errno));
+    }
+
+    // This function replaces graph with the one stored in the file
+    // and stores its frontier plan to plan, which can be passed to
+    // the constructor of FrontierManager.
+    static void read(const std::string& filename, tdzdd::Graph& graph,
+                     std::vector<int>& plan) {
+        tdzdd::MessageHandler mh;
+        mh.begin("reading") << " \"" << filename << "\" ...";
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error(strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error(strerror(errno));
+        }
+        const size_t size = st.st_size;
+        if (size == 0) {
+            close(fd);
+            throw std::runtime_error("ERROR: Not a graph binary");
+        }
+        void* p = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error(strerror(errno));
+        try {
+            load(static_cast<const char*>(p), size, graph, plan);
+        }
+        catch (...) {
+            munmap(p, size);
+            throw;
+        }
+        munmap(p, size);
+#else
+        std::ifstream fin(filename.c_str(), std::ios::in | std::ios::binary);
+        if (!fin) throw std::runtime_error(strerror(errno));
+        std::string buf((std::istreambuf_iterator<char>(fin)),
+                        std::istreambuf_iterator<char>());
+        load(buf.data(), buf.size(), graph, plan);
+#endif
+        mh.end();
+    }
+};
+
+#endif // GRAPH_BINARY_HPP
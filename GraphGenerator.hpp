@@ -0,0 +1,525 @@
+#ifndef GRAPH_GENERATOR_HPP
+#define GRAPH_GENERATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace tdzdd;
+
+// This class generates graphs directly into tdzdd::Graph.
+// The vertices are named "1", "2", ... in the order they are made, and
+// the edges are ordered so that the frontiers stay narrow: lattices row
+// by row, random geometric graphs by x-coordinate and the other random
+// graphs in breadth-first order. Isolated vertices are not part of the
+// graph.
+// Random graphs are determined by the seed on every platform.
+class GraphGenerator {
+private:
+    typedef tdzdd::Graph::VertexNumberPair Edge;
+
+    // xorshift generator
+    class Random {
+    private:
+        unsigned long long x_;
+
+    public:
+        Random(unsigned long long seed) :
+            x_(seed * 2685821657736338717ULL + 1) {
+        }
+
+        unsigned long long next() {
+            x_ ^= x_ << 13;
+            x_ ^= x_ >> 7;
+            x_ ^= x_ << 17;
+            return x_;
+        }
+
+        // uniform in [0, n)
+        int below(int n) {
+            return static_cast<int>((next() >> 16) % n);
+        }
+
+        // uniform in [0, 1)
+        double uniform() {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+    };
+
+    // stores the graph whose vertices are named 1..n and edges are in order;
+    // the vertices are numbered in the order they leave the frontier
+    // as update() does, which the frontier specs rely on
+    static void assign(tdzdd::Graph& graph, int n, std::vector<Edge>& edges) {
+        std::vector<int> last(n + 1, -1);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            last[edges[i].first] = static_cast<int>(i);
+            last[edges[i].second] = static_cast<int>(i);
+        }
+        std::vector<int> newNumber(n + 1, 0);
+        tdzdd::NameTable names;
+        char buf[16];
+        int k = 0;
+        for (size_t i = 0; i < edges.size(); ++i) {
+            int ends[2] = {edges[i].first, edges[i].second};
+            for (int j = 0; j < 2; ++j) {
+                int v = ends[j];
+                if (last[v] != static_cast<int>(i) || newNumber[v] != 0) {
+                    continue;
+                }
+                newNumber[v] = ++k;
+                char* p = buf + sizeof(buf);
+                for (int x = v; x > 0; x /= 10) {
+                    *--p = static_cast<char>('0' + x % 10);
+                }
+                names.intern(p, buf + sizeof(buf) - p);
+            }
+        }
+        for (size_t i = 0; i < edges.size(); ++i) {
+            edges[i] = Edge(newNumber[edges[i].first],
+                            newNumber[edges[i].second]);
+        }
+        graph.clearColors();
+        graph.assignNumbered(names, edges);
+    }
+
+    // renumbers the vertices of the edges by newNumber (0 for isolated ones),
+    // and sorts the edges by their smaller and then larger endpoints,
+    // dropping loops and multiple edges
+    static void renumber(std::vector<Edge>& edges,
+                         const std::vector<int>& newNumber) {
+        size_t k = 0;
+        for (size_t i = 0; i < edges.size(); ++i) {
+            int u = newNumber[edges[i].first];
+            int v = newNumber[edges[i].second];
+            if (u == v) continue;
+            edges[k++] = (u < v) ? Edge(u, v) : Edge(v, u);
+        }
+        edges.resize(k);
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    }
+
+    // drops isolated vertices keeping the order of the others;
+    // returns the number of the remaining vertices
+    static int compact(int n, std::vector<Edge>& edges) {
+        std::vector<int> newNumber(n + 1, 0);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (edges[i].first != edges[i].second) {
+                newNumber[edges[i].first] = 1;
+                newNumber[edges[i].second] = 1;
+            }
+        }
+        int k = 0;
+        for (int v = 1; v <= n; ++v) {
+            if (newNumber[v] != 0) newNumber[v] = ++k;
+        }
+        renumber(edges, newNumber);
+        return k;
+    }
+
+    // renumbers the vertices in breadth-first order, which bounds
+    // the frontiers by the width of the BFS layers;
+    // returns the number of the non-isolated vertices
+    static int orderByBfs(int n, std::vector<Edge>& edges) {
+        std::vector<int> start(n + 2, 0);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            ++start[edges[i].first + 1];
+            ++start[edges[i].second + 1];
+        }
+        for (int v = 1; v <= n + 1; ++v) {
+            start[v] += start[v - 1];
+        }
+        std::vector<int> adj(start[n + 1]);
+        {
+            std::vector<int> pos(start.begin(), start.end() - 1);
+            for (size_t i = 0; i < edges.size(); ++i) {
+                adj[pos[edges[i].first]++] = edges[i].second;
+                adj[pos[edges[i].second]++] = edges[i].first;
+            }
+        }
+
+        std::vector<int> newNumber(n + 1, 0);
+        std::vector<int> queue;
+        queue.reserve(n);
+        int k = 0;
+        for (int r = 1; r <= n; ++r) {
+            if (newNumber[r] != 0 || start[r] == start[r + 1]) continue;
+            newNumber[r] = ++k;
+            queue.push_back(r);
+            for (size_t q = queue.size() - 1; q < queue.size(); ++q) {
+                int u = queue[q];
+                for (int j = start[u]; j < start[u + 1]; ++j) {
+                    int v = adj[j];
+                    if (newNumber[v] == 0) {
+                        newNumber[v] = ++k;
+                        queue.push_back(v);
+                    }
+                }
+            }
+        }
+        renumber(edges, newNumber);
+        return k;
+    }
+
+    static void checkSize(bool ok, const std::string& what) {
+        if (!ok) {
+            throw std::runtime_error("ERROR: Illegal size of " + what);
+        }
+    }
+
+public:
+    // w x h grid
+    static void grid(tdzdd::Graph& graph, int w, int h) {
+        checkSize(w >= 1 && h >= 1 && w * h >= 2, "grid");
+        std::vector<Edge> edges;
+        edges.reserve(2 * static_cast<size_t>(w) * h);
+        for (int i = 0; i < h; ++i) {
+            for (int j = 0; j < w; ++j) {
+                int v = i * w + j + 1;
+                if (j < w - 1) edges.push_back(Edge(v, v + 1));
+                if (i < h - 1) edges.push_back(Edge(v, v + w));
+            }
+        }
+        assign(graph, w * h, edges);
+    }
+
+    // w x h torus, the grid with wrap-around edges (w, h >= 3)
+    static void torus(tdzdd::Graph& graph, int w, int h) {
+        checkSize(w >= 3 && h >= 3, "torus");
+        std::vector<Edge> edges;
+        edges.reserve(2 * static_cast<size_t>(w) * h);
+        for (int i = 0; i < h; ++i) {
+            for (int j = 0; j < w; ++j) {
+                int v = i * w + j + 1;
+                edges.push_back(Edge(v, (j < w - 1) ? v + 1 : v - w + 1));
+                edges.push_back(Edge(v, (i < h - 1) ? v + w : j + 1));
+            }
+        }
+        assign(graph, w * h, edges);
+    }
+
+    // w x h king graph, the grid with both diagonals of every cell
+    static void king(tdzdd::Graph& graph, int w, int h) {
+        checkSize(w >= 1 && h >= 1 && w * h >= 2, "king graph");
+        std::vector<Edge> edges;
+        edges.reserve(4 * static_cast<size_t>(w) * h);
+        for (int i = 0; i < h; ++i) {
+            for (int j = 0; j < w; ++j) {
+                int v = i * w + j + 1;
+                if (j < w - 1) edges.push_back(Edge(v, v + 1));
+                if (i < h - 1) {
+                    if (j > 0) edges.push_back(Edge(v, v + w - 1));
+                    edges.push_back(Edge(v, v + w));
+                    if (j < w - 1) edges.push_back(Edge(v, v + w + 1));
+                }
+            }
+        }
+        assign(graph, w * h, edges);
+    }
+
+    // w x h triangular lattice, the grid with one diagonal of every cell
+    static void triangular(tdzdd::Graph& graph, int w, int h) {
+        checkSize(w >= 1 && h >= 1 && w * h >= 2, "triangular lattice");
+        std::vector<Edge> edges;
+        edges.reserve(3 * static_cast<size_t>(w) * h);
+        for (int i = 0; i < h; ++i) {
+            for (int j = 0; j < w; ++j) {
+                int v = i * w + j + 1;
+                if (j < w - 1) edges.push_back(Edge(v, v + 1));
+                if (i < h - 1) {
+                    edges.push_back(Edge(v, v + w));
+                    if (j < w - 1) edges.push_back(Edge(v, v + w + 1));
+                }
+            }
+        }
+        assign(graph, w * h, edges);
+    }
+
+    // 2 x n ladder
+    static void ladder(tdzdd::Graph& graph, int n) {
+        grid(graph, 2, n);
+    }
+
+    // complete graph on n vertices
+    static void complete(tdzdd::Graph& graph, int n) {
+        checkSize(n >= 2, "complete graph");
+        std::vector<Edge> edges;
+        edges.reserve(static_cast<size_t>(n) * (n - 1) / 2);
+        for (int u = 1; u <= n; ++u) {
+            for (int v = u + 1; v <= n; ++v) {
+                edges.push_back(Edge(u, v));
+            }
+        }
+        assign(graph, n, edges);
+    }
+
+private:
+    // This function pairs the stubs of a random d-regular multigraph
+    // on n vertices and repairs loops and multiple edges by switching
+    // each of them with a random pair. It stores the edges and returns
+    // true if the graph becomes simple within 1000 rounds.
+    static bool pairStubs(int n, int d, Random& rand,
+                          std::vector<Edge>& edges) {
+        std::vector<int> stubs(static_cast<size_t>(n) * d);
+        for (size_t i = 0; i < stubs.size(); ++i) {
+            stubs[i] = static_cast<int>(i / d) + 1;
+        }
+        for (size_t i = stubs.size() - 1; i > 0; --i) {
+            std::swap(stubs[i], stubs[(rand.next() >> 16) % (i + 1)]);
+        }
+
+        const size_t m = stubs.size() / 2;
+        std::vector<std::pair<Edge,size_t> > sorted(m);
+        bool simple = false;
+        for (int round = 0; round < 1000 && !simple; ++round) {
+            for (size_t i = 0; i < m; ++i) {
+                int u = stubs[2 * i];
+                int v = stubs[2 * i + 1];
+                sorted[i].first = (u < v) ? Edge(u, v) : Edge(v, u);
+                sorted[i].second = i;
+            }
+            std::sort(sorted.begin(), sorted.end());
+            simple = true;
+            for (size_t k = 0; k < m; ++k) {
+                const Edge& e = sorted[k].first;
+                if (e.first == e.second
+                    || (k > 0 && e == sorted[k - 1].first)) {
+                    // (a,b),(c,d) -> (a,d),(c,b)
+                    size_t i = sorted[k].second;
+                    size_t j = (rand.next() >> 16) % m;
+                    std::swap(stubs[2 * i + 1], stubs[2 * j + 1]);
+                    simple = false;
+                }
+            }
+        }
+
+        edges.resize(m);
+        for (size_t i = 0; i < m; ++i) {
+            edges[i] = Edge(stubs[2 * i], stubs[2 * i + 1]);
+        }
+        return simple;
+    }
+
+public:
+    // random d-regular graph on n vertices by the pairing model,
+    // which is restarted until the repaired graph is simple.
+    // If d > (n - 1) / 2, the complement of a random (n - 1 - d)-regular
+    // graph is made instead, since dense pairings are rarely repaired.
+    static void randomRegular(tdzdd::Graph& graph, int n, int d,
+                              unsigned long long seed) {
+        checkSize(n >= 2 && d >= 1 && d < n
+                  && static_cast<long long>(n) * d % 2 == 0, "regular graph");
+        Random rand(seed);
+        const bool complement = d > (n - 1) / 2;
+        const int dd = complement ? n - 1 - d : d;
+
+        std::vector<Edge> edges;
+        if (dd > 0) {
+            int attempt = 0;
+            while (!pairStubs(n, dd, rand, edges)) {
+                if (++attempt == 100) {
+                    throw std::runtime_error(
+                        "ERROR: Cannot make a simple regular graph");
+                }
+            }
+        }
+
+        if (complement) {
+            std::vector<char> adjacent(static_cast<size_t>(n) * n);
+            for (size_t i = 0; i < edges.size(); ++i) {
+                int u = edges[i].first - 1;
+                int v = edges[i].second - 1;
+                adjacent[static_cast<size_t>(u) * n + v] = 1;
+                adjacent[static_cast<size_t>(v) * n + u] = 1;
+            }
+            edges.clear();
+            for (int u = 1; u <= n; ++u) {
+                for (int v = u + 1; v <= n; ++v) {
+                    if (!adjacent[static_cast<size_t>(u - 1) * n + v - 1]) {
+                        edges.push_back(Edge(u, v));
+                    }
+                }
+            }
+        }
+
+        int k = orderByBfs(n, edges);
+        assign(graph, k, edges);
+    }
+
+    // Erdos-Renyi graph with m edges chosen uniformly among n vertices
+    static void erdosRenyi(tdzdd::Graph& graph, int n, long long m,
+                           unsigned long long seed) {
+        checkSize(n >= 2 && m >= 1
+                  && m <= static_cast<long long>(n) * (n - 1) / 2,
+                  "Erdos-Renyi graph");
+        Random rand(seed);
+        std::vector<Edge> edges;
+        edges.reserve(m);
+        while (edges.size() < static_cast<size_t>(m)) {
+            while (edges.size() < static_cast<size_t>(m)) {
+                int u = rand.below(n) + 1;
+                int v = rand.below(n) + 1;
+                if (u == v) continue;
+                edges.push_back((u < v) ? Edge(u, v) : Edge(v, u));
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        }
+        int k = orderByBfs(n, edges);
+        assign(graph, k, edges);
+    }
+
+    // random geometric graph: n points in the unit square,
+    // two of which are adjacent if they are within distance r
+    static void randomGeometric(tdzdd::Graph& graph, int n, double r,
+                                unsigned long long seed) {
+        checkSize(n >= 2 && r > 0, "geometric graph");
+        Random rand(seed);
+        std::vector<std::pair<double,double> > points(n);
+        for (int i = 0; i < n; ++i) {
+            points[i].first = rand.uniform();
+            points[i].second = rand.uniform();
+        }
+        std::sort(points.begin(), points.end());
+
+        // bucket the points into cells of side r
+        const int c = std::max(1, std::min(static_cast<int>(1 / r), 4096));
+        std::vector<int> cellStart(static_cast<size_t>(c) * c + 1, 0);
+        std::vector<int> cellOf(n);
+        for (int u = 0; u < n; ++u) {
+            int cx = std::min(static_cast<int>(points[u].first * c), c - 1);
+            int cy = std::min(static_cast<int>(points[u].second * c), c - 1);
+            cellOf[u] = cx * c + cy;
+            ++cellStart[cellOf[u] + 1];
+        }
+        for (size_t i = 1; i < cellStart.size(); ++i) {
+            cellStart[i] += cellStart[i - 1];
+        }
+        std::vector<int> cells(n);
+        {
+            std::vector<int> pos(cellStart.begin(), cellStart.end() - 1);
+            for (int u = 0; u < n; ++u) {
+                cells[pos[cellOf[u]]++] = u;
+            }
+        }
+
+        std::vector<Edge> edges;
+        for (int u = 0; u < n; ++u) {
+            int cx = cellOf[u] / c;
+            int cy = cellOf[u] % c;
+            for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, c - 1);
+                 ++x) {
+                for (int y = std::max(cy - 1, 0);
+                     y <= std::min(cy + 1, c - 1); ++y) {
+                    for (int k = cellStart[x * c + y];
+                         k < cellStart[x * c + y + 1]; ++k) {
+                        int v = cells[k];
+                        if (v <= u) continue;
+                        double dx = points[v].first - points[u].first;
+                        double dy = points[v].second - points[u].second;
+                        if (dx * dx + dy * dy <= r * r) {
+                            edges.push_back(Edge(u + 1, v + 1));
+                        }
+                    }
+                }
+            }
+        }
+        int k = compact(n, edges);
+        assign(graph, k, edges);
+    }
+
+    // planar graph resembling a road network: the w x h grid
+    // where each street segment is missing with probability 0.15
+    // and each block is cut by a diagonal street with probability 0.15
+    static void roadLike(tdzdd::Graph& graph, int w, int h,
+                         unsigned long long seed) {
+        checkSize(w >= 2 && h >= 2, "road-like graph");
+        Random rand(seed);
+        std::vector<Edge> edges;
+        edges.reserve(2 * static_cast<size_t>(w) * h);
+        for (int i = 0; i < h; ++i) {
+            for (int j = 0; j < w; ++j) {
+                int v = i * w + j + 1;
+                if (j < w - 1 && rand.uniform() >= 0.15) {
+                    edges.push_back(Edge(v, v + 1));
+                }
+                if (i < h - 1 && rand.uniform() >= 0.15) {
+                    edges.push_back(Edge(v, v + w));
+                }
+                if (i < h - 1 && j < w - 1 && rand.uniform() < 0.15) {
+                    if (rand.next() % 2 == 0) {
+                        edges.push_back(Edge(v, v + w + 1));
+                    } else {
+                        edges.push_back(Edge(v + 1, v + w));
+                    }
+                }
+            }
+        }
+        int k = compact(w * h, edges);
+        if (k < 2) {
+            throw std::runtime_error("ERROR: Empty road-like graph");
+        }
+        assign(graph, k, edges);
+    }
+
+    // This function generates the graph described by spec, which is one of
+    //   grid:<w>x<h>  torus:<w>x<h>  king:<w>x<h>  triangular:<w>x<h>
+    //   ladder:<n>  complete:<n>  road:<w>x<h>[:<seed>]
+    //   regular:<n>:<d>[:<seed>]  er:<n>:<m>[:<seed>]
+    //   geometric:<n>:<r>[:<seed>]
+    // where <w>x<h> may be abbreviated to <n> for <n>x<n>.
+    static void generate(tdzdd::Graph& graph, const std::string& spec) {
+        std::vector<std::string> args;
+        for (std::string::size_type p = 0;;) {
+            std::string::size_type q = spec.find(':', p);
+            args.push_back(spec.substr(p, q - p));
+            if (q == std::string::npos) break;
+            p = q + 1;
+        }
+        const std::string& family = args[0];
+        const size_t num = args.size() - 1;
+        int w = 0;
+        int h = 0;
+        if (num >= 1) {
+            std::string::size_type x = args[1].find('x');
+            w = atoi(args[1].c_str());
+            h = (x == std::string::npos) ? w : atoi(args[1].c_str() + x + 1);
+        }
+        unsigned long long seed = 1;
+
+        if (num == 1 && family == "grid") {
+            grid(graph, w, h);
+        } else if (num == 1 && family == "torus") {
+            torus(graph, w, h);
+        } else if (num == 1 && family == "king") {
+            king(graph, w, h);
+        } else if (num == 1 && family == "triangular") {
+            triangular(graph, w, h);
+        } else if (num == 1 && family == "ladder") {
+            ladder(graph, w);
+        } else if (num == 1 && family == "complete") {
+            complete(graph, w);
+        } else if ((num == 1 || num == 2) && family == "road") {
+            if (num == 2) seed = strtoull(args[2].c_str(), NULL, 10);
+            roadLike(graph, w, h, seed);
+        } else if ((num == 2 || num == 3) && (family == "regular"
+                   || family == "er" || family == "geometric")) {
+            if (num == 3) seed = strtoull(args[3].c_str(), NULL, 10);
+            if (family == "regular") {
+                randomRegular(graph, w, atoi(args[2].c_str()), seed);
+            } else if (family == "er") {
+                erdosRenyi(graph, w, strtoll(args[2].c_str(), NULL, 10), seed);
+            } else {
+                randomGeometric(graph, w, atof(args[2].c_str()), seed);
+            }
+        } else {
+            throw std::runtime_error("ERROR: " + spec
+                                     + ": Unknown graph generator");
+        }
+    }
+};
+
+#endif // GRAPH_GENERATOR_HPP
@@ -0,0 +1,130 @@
+#ifndef PRUNE_COUNTER_HPP
+#define PRUNE_COUNTER_HPP
+
+// Counters of the reasons why getChild of the frontier specs returns
+// the 0-terminal. A spec returns PRUNE(spec, reason, level) instead of 0,
+// which is just 0 unless the program is compiled with -DPRUNE_COUNTER,
+// so the counters cost nothing in normal builds.
+// With -DPRUNE_COUNTER, each thread counts in its own table, and
+// PruneCounter::report() adds them up by spec, reason and level, and
+// PruneCounter::reportAtExit() makes the program report them on exit.
+// spec and reason must be string literals.
+
+#ifdef PRUNE_COUNTER
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+class PruneCounter {
+private:
+    static const int MAX_THREADS = 256;
+
+    typedef std::pair<const char*, const char*> Key;
+    // counts[level] for each (spec, reason)
+    typedef std::map<Key, std::vector<unsigned long long> > Table;
+
+    static Table* tables() {
+        static Table t[MAX_THREADS];
+        return t;
+    }
+
+    struct NameLess {
+        bool operator()(const Key& a, const Key& b) const {
+            int c = std::strcmp(a.first, b.first);
+            return c != 0 ? c < 0 : std::strcmp(a.second, b.second) < 0;
+        }
+    };
+
+public:
+    // This function counts a pruning and returns 0 (the 0-terminal).
+    static int count(const char* spec, const char* reason, int level) {
+#ifdef _OPENMP
+        Table& table = tables()[omp_get_thread_num() % MAX_THREADS];
+#else
+        Table& table = tables()[0];
+#endif
+        std::vector<unsigned long long>& counts = table[Key(spec, reason)];
+        if (counts.size() <= static_cast<size_t>(level)) {
+            counts.resize(level + 1);
+        }
+        ++counts[level];
+        return 0;
+    }
+
+    // This function discards all the counts.
+    static void clear() {
+        for (int y = 0; y < MAX_THREADS; ++y) {
+            tables()[y].clear();
+        }
+    }
+
+    // This function writes, for each spec and reason, the total count and
+    // the counts of the levels in the form level:count.
+    static void report(std::ostream& os) {
+        std::map<Key, std::vector<unsigned long long>, NameLess> sum;
+        for (int y = 0; y < MAX_THREADS; ++y) {
+            for (Table::const_iterator t = tables()[y].begin();
+                 t != tables()[y].end(); ++t) {
+                std::vector<unsigned long long>& s = sum[t->first];
+                if (s.size() < t->second.size()) {
+                    s.resize(t->second.size());
+                }
+                for (size_t i = 0; i < t->second.size(); ++i) {
+                    s[i] += t->second[i];
+                }
+            }
+        }
+
+        os << "# spec\treason\ttotal\tlevel:count ..." << std::endl;
+        for (std::map<Key, std::vector<unsigned long long>,
+                 NameLess>::const_iterator t = sum.begin();
+             t != sum.end(); ++t) {
+            unsigned long long total = 0;
+            for (size_t i = 0; i < t->second.size(); ++i) {
+                total += t->second[i];
+            }
+            os << t->first.first << "\t" << t->first.second << "\t" << total
+               << "\t";
+            for (size_t i = t->second.size(); i-- > 0;) {
+                if (t->second[i] > 0) {
+                    os << " " << i << ":" << t->second[i];
+                }
+            }
+            os << std::endl;
+        }
+    }
+
+    // This function makes the program call report(std::cerr) when it
+    // exits, whichever way main returns.
+    static void reportAtExit() {
+        // the tables must be constructed before the handler is registered
+        // so that they are destroyed after it runs
+        tables();
+        std::atexit(reportToCerr);
+    }
+
+private:
+    static void reportToCerr() {
+        report(std::cerr);
+    }
+};
+
+#define PRUNE(spec, reason, level) PruneCounter::count(spec, reason, level)
+
+#else // PRUNE_COUNTER
+
+#define PRUNE(spec, reason, level) 0
+
+#endif // PRUNE_COUNTER
+
+#endif // PRUNE_COUNTER_HPP
@@ -0,0 +1,200 @@
+#ifndef SUBGRAPH_KIND_HPP
+#define SUBGRAPH_KIND_HPP
+
+#include <climits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tdzdd/DdSpecOp.hpp"
+
+using namespace tdzdd;
+
+// The kinds of subgraphs that the program can construct.
+// Each kind is named by its command-line option without "--".
+class SubgraphKind {
+private:
+    static const char* const* names() {
+        static const char* const NAMES[] = {
+            "path", "hampath", "cycle", "letter_O", "hamcycle",
+            "path_m", "hampath_m", "cycle_m", "hamcycle_m",
+            "forest", "tree", "stree", "matching", "cmatching",
+            "letter_I", "letter_L", "letter_P", 0
+        };
+        return NAMES;
+    }
+
+    // This functor constructs the ZDD of a spec.
+    // The spec is wrapped even without lookahead,
+    // so that the builders are compiled only once for each spec.
+    class Builder {
+    private:
+        const MemoryBudget* budget;
+        bool reduce;
+        bool lookahead;
+        const DepthFirstMode* depthFirst;
+        DdStructure<2>& dd;
+
+    public:
+        Builder(const MemoryBudget* budget, bool reduce, bool lookahead,
+                const DepthFirstMode* depthFirst, DdStructure<2>& dd)
+            : budget(budget), reduce(reduce), lookahead(lookahead),
+              depthFirst(depthFirst), dd(dd) {
+        }
+
+        template<typename SPEC>
+        void operator()(const SPEC& spec) {
+            if (depthFirst != 0) {
+                dd = DdStructure<2>(zddSkipForced(spec, lookahead),
+                                    *depthFirst);
+            } else if (budget != 0) {
+                dd = DdStructure<2>(zddSkipForced(spec, lookahead), *budget,
+                                    reduce);
+            } else {
+                dd = DdStructure<2>(zddSkipForced(spec, lookahead), false,
+                                    reduce);
+            }
+        }
+    };
+
+    // This functor searches for one solution of a spec.
+    class Finder {
+    private:
+        bool useMP;
+        std::vector<std::pair<int, int> >& instance;
+
+    public:
+        bool found;
+
+        Finder(bool useMP, std::vector<std::pair<int, int> >& instance)
+            : useMP(useMP), instance(instance), found(false) {
+        }
+
+        template<typename SPEC>
+        void operator()(const SPEC& spec) {
+            FeasibilitySearcher<SPEC> searcher(spec, useMP);
+            found = searcher.search(instance);
+        }
+    };
+
+    // This function makes the spec of the subgraphs of the kind
+    // and applies op to it.
+    template<typename OP>
+    static void apply(const std::string& kind, const tdzdd::Graph& graph,
+                      const FrontierManager& fm, int s, int t, OP& op) {
+        if (kind == "path") {
+            FrontierSTPathSpec spec(graph, false, s, t, &fm);
+            op(spec);
+        } else if (kind == "hampath") {
+            FrontierSTPathSpec spec(graph, true, s, t, &fm);
+            op(spec);
+        } else if (kind == "cycle" || kind == "letter_O") {
+            FrontierSingleCycleSpec spec(graph, &fm);
+            op(spec);
+        } else if (kind == "hamcycle") {
+            FrontierSingleHamiltonianCycleSpec spec(graph, &fm);
+            op(spec);
+        } else if (kind == "path_m") {
+            FrontierMateSpec spec(graph, false, s, t, &fm);
+            op(spec);
+        } else if (kind == "hampath_m") {
+            FrontierMateSpec spec(graph, true, s, t, &fm);
+            op(spec);
+        } else if (kind == "cycle_m") {
+            FrontierMateSpec spec(graph, false, &fm);
+            op(spec);
+        } else if (kind == "hamcycle_m") {
+            FrontierMateSpec spec(graph, true, &fm);
+            op(spec);
+        } else if (kind == "forest") {
+            FrontierForestSpec spec(graph, &fm);
+            op(spec);
+        } else if (kind == "tree") {
+            FrontierTreeSpec spec(graph, false, &fm);
+            op(spec);
+        } else if (kind == "stree") {
+            FrontierTreeSpec spec(graph, true, &fm);
+            op(spec);
+        } else if (kind == "matching") {
+            FrontierMatchingSpec spec(graph, false, &fm);
+            op(spec);
+        } else if (kind == "cmatching") {
+            FrontierMatchingSpec spec(graph, true, &fm);
+            op(spec);
+        } else if (kind == "letter_I" || kind == "letter_L"
+                   || kind == "letter_P") {
+            // the ranges outlive the spec, which only refers to them
+            IntRange any(0, INT_MAX);
+            IntRange one(1, 1);
+            IntRange two(2, 2);
+            std::vector<IntSubset*> degRanges;
+            degRanges.push_back(&any);
+            if (kind == "letter_P") {
+                degRanges.push_back(&one);
+                degRanges.push_back(&any);
+                degRanges.push_back(&one);
+            } else {
+                degRanges.push_back(&two);
+                degRanges.push_back(&any);
+            }
+            FrontierDegreeDistributionSpec spec(graph, degRanges, true, &fm);
+            op(spec);
+        } else {
+            throw std::runtime_error("ERROR: " + kind
+                                     + ": No such kind of subgraphs");
+        }
+    }
+
+public:
+    // This function returns whether kind is the name of a kind.
+    static bool isKind(const std::string& kind) {
+        for (const char* const* p = names(); *p != 0; ++p) {
+            if (kind == *p) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // This function returns whether the kind uses the terminals s and t.
+    static bool hasTerminals(const std::string& kind) {
+        return kind == "path" || kind == "hampath"
+            || kind == "path_m" || kind == "hampath_m";
+    }
+
+    // This function constructs the ZDD of the subgraphs of the kind
+    // on graph, using the frontiers in fm, and stores it to dd.
+    // s and t are the vertex numbers of the terminals of paths.
+    // If budget is given, the construction is bounded by it.
+    // If reduce is true, the ZDD is reduced during the construction.
+    // If lookahead is true, the levels whose edges cannot be taken are
+    // skipped by the isForcedZero hooks of the specs.
+    // If depthFirst is given, the reduced ZDD is built depth-first with it
+    // instead, and budget and reduce are ignored.
+    static void construct(const std::string& kind, const tdzdd::Graph& graph,
+                          const FrontierManager& fm, int s, int t,
+                          DdStructure<2>& dd,
+                          const MemoryBudget* budget = NULL,
+                          bool reduce = false, bool lookahead = false,
+                          const DepthFirstMode* depthFirst = NULL) {
+        Builder op(budget, reduce, lookahead, depthFirst, dd);
+        apply(kind, graph, fm, s, t, op);
+    }
+
+    // This function searches for one subgraph of the kind on graph
+    // without constructing the ZDD, and stores it to instance as
+    // the pairs (level, value), where the level of the edge of index e
+    // is the number of edges minus e.
+    // If useMP is true, a portfolio of searches runs in parallel.
+    // It returns false if no subgraph of the kind exists.
+    static bool findOne(const std::string& kind, const tdzdd::Graph& graph,
+                        const FrontierManager& fm, int s, int t,
+                        std::vector<std::pair<int, int> >& instance,
+                        bool useMP = false) {
+        Finder op(useMP, instance);
+        apply(kind, graph, fm, s, t, op);
+        return op.found;
+    }
+};
+
+#endif // SUBGRAPH_KIND_HPP
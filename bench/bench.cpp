@@ -0,0 +1,315 @@
+// Benchmark suite of the frontier-based specs on canonical graph families.
+//
+// Usage: bench/bench [--out=<file>] [--baseline=<file>] [--tolerance=<r>]
+//                    [--filter=<substring>] [--update-baseline]
+//
+// Each case constructs the ZDD of one kind of subgraphs on one graph,
+// in a child process of its own so that the peak RSS belongs to the case.
+// A kind followed by @size:<lo>-<hi> (or @size_mp:<lo>-<hi> to use
+// multiple threads) subsets the reduced ZDD to the subgraphs with
+// lo to hi edges, and the sizes and solutions are those of the subset.
+// The results are written as tab-separated lines
+//   case vertices edges nodes reduced solutions seconds maxrss_kb
+// to the output file (default: bench/results.tsv).
+//
+// With --baseline, each case is compared with the line of the same case
+// in the baseline file. A case regresses if its ZDD size or its number of
+// solutions differs, or if its time or peak RSS exceeds the baseline by
+// more than the tolerance ratio (default: 0.25) beyond a small noise floor.
+// The exit status is 1 if any case regresses or fails.
+// --update-baseline writes the results to the baseline file instead.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "tdzdd/DdSpec.hpp"
+#include "tdzdd/DdStructure.hpp"
+#include "tdzdd/util/Graph.hpp"
+#include "tdzdd/util/ResourceUsage.hpp"
+#include "tdzdd/spec/SizeConstraint.hpp"
+
+using namespace tdzdd;
+
+#include "FrontierManager.hpp"
+#include "FrontierSingleCycle.hpp"
+#include "FrontierSingleHamiltonianCycle.hpp"
+#include "FrontierSTPath.hpp"
+#include "FrontierForest.hpp"
+#include "FrontierTree.hpp"
+#include "FrontierMatching.hpp"
+#include "FrontierMate.hpp"
+#include "FrontierDegreeDistribution.hpp"
+#include "GraphGenerator.hpp"
+#include "SubgraphKind.hpp"
+
+struct Family {
+    const char* name;  // a graph for GraphGenerator::generate
+    const char* kinds;
+};
+
+// the kinds are run on the graph of each family
+const Family FAMILIES[] = {
+    {"grid:6x6", "cycle cycle_m hamcycle path path_m hampath forest tree"
+                 " stree matching cmatching letter_P"},
+    {"grid:9x9", "cycle path matching"},
+    {"torus:4x6", "cycle hamcycle forest matching"},
+    {"king:5x5", "cycle hamcycle path forest stree matching letter_P"},
+    {"triangular:6x6", "cycle path forest stree matching"},
+    {"ladder:60", "cycle hamcycle path hampath forest stree matching"
+                  " cmatching"},
+    {"complete:8", "cycle hamcycle path path_m hampath forest tree stree"
+                   " matching cmatching"},
+    {"road:10x10:1", "cycle path forest stree matching"},
+    {"geometric:60:0.2:1", "cycle path stree matching"},
+    {"regular:24:3:1", "cycle hamcycle path forest stree matching"},
+    {"er:20:40:1", "cycle path forest stree matching"},
+    {"grid:10x10", "cycle@size:30-60 cycle@size_mp:30-60 cycle@size:80"},
+    {0, 0}
+};
+
+struct Result {
+    std::string name;
+    int vertices;
+    int edges;
+    size_t nodes;
+    size_t reduced;
+    std::string solutions;
+    double seconds;
+    long maxrss;
+
+    Result() : vertices(0), edges(0), nodes(0), reduced(0), seconds(0),
+               maxrss(0) {
+    }
+
+    std::string toLine() const {
+        std::ostringstream oss;
+        oss << name << "\t" << vertices << "\t" << edges << "\t" << nodes
+            << "\t" << reduced << "\t" << solutions << "\t" << seconds
+            << "\t" << maxrss;
+        return oss.str();
+    }
+
+    bool fromLine(const std::string& line) {
+        std::istringstream iss(line);
+        return static_cast<bool>(iss >> name >> vertices >> edges >> nodes
+                                 >> reduced >> solutions >> seconds >> maxrss);
+    }
+};
+
+Result runCase(const std::string& family, const std::string& kind) {
+    Result result;
+    result.name = family + "/" + kind;
+    tdzdd::Graph graph;
+    GraphGenerator::generate(graph, family);
+    result.vertices = graph.vertexSize();
+    result.edges = graph.edgeSize();
+
+    std::string::size_type at = kind.find('@');
+    std::string subset = (at != std::string::npos) ? kind.substr(at + 1) : "";
+
+    double start = getWallClockTime();
+    FrontierManager fm(graph);
+    DdStructure<2> dd;
+    // path terminals are the vertices named 1 and n as in the program
+    int s = graph.getVertex("1");
+    int t = graph.getVertex(tdzdd::to_string(graph.vertexSize()));
+    SubgraphKind::construct(kind.substr(0, at), graph, fm, s, t, dd);
+    if (!subset.empty()) {
+        bool mp = subset.compare(0, 8, "size_mp:") == 0;
+        int lo, hi;
+        int k = std::sscanf(subset.c_str() + (mp ? 8 : 5), "%d-%d", &lo, &hi);
+        if ((!mp && subset.compare(0, 5, "size:") != 0) || k < 1) {
+            throw std::runtime_error("ERROR: " + subset + ": Unknown subset");
+        }
+        if (k == 1) hi = lo;
+        dd.zddReduce();
+        dd.useMultiProcessors(mp);
+        dd.zddSubset(SizeConstraint(graph.edgeSize(), IntRange(lo, hi)));
+    }
+    result.nodes = dd.size();
+    dd.zddReduce();
+    result.seconds = getWallClockTime() - start;
+    result.reduced = dd.size();
+    result.solutions = dd.zddCardinality();
+    result.maxrss = ResourceUsage().maxrss;
+    return result;
+}
+
+// runs the case in a child process and returns its result line
+std::string runIsolated(const std::string& family, const std::string& kind) {
+#ifndef _WIN32
+    int fds[2];
+    if (pipe(fds) != 0) throw std::runtime_error("ERROR: pipe failed");
+    pid_t pid = fork();
+    if (pid < 0) throw std::runtime_error("ERROR: fork failed");
+    if (pid == 0) {
+        close(fds[0]);
+        std::string line;
+        try {
+            line = runCase(family, kind).toLine();
+        } catch (std::exception& e) {
+            line = std::string("ERROR ") + e.what();
+        }
+        if (write(fds[1], line.data(), line.size()) < 0) _exit(1);
+        close(fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+    std::string line;
+    char buf[4096];
+    ssize_t k;
+    while ((k = read(fds[0], buf, sizeof(buf))) > 0) {
+        line.append(buf, k);
+    }
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (line.empty()) line = "ERROR the case was killed";
+    return line;
+#else
+    try {
+        return runCase(family, kind).toLine();
+    } catch (std::exception& e) {
+        return std::string("ERROR ") + e.what();
+    }
+#endif
+}
+
+std::map<std::string,Result> readBaseline(const std::string& filename) {
+    std::map<std::string,Result> baseline;
+    std::ifstream fin(filename.c_str());
+    if (!fin) {
+        throw std::runtime_error("ERROR: " + filename + ": Cannot open");
+    }
+    std::string line;
+    while (std::getline(fin, line)) {
+        Result r;
+        if (!line.empty() && line[0] != '#' && r.fromLine(line)) {
+            baseline[r.name] = r;
+        }
+    }
+    return baseline;
+}
+
+// returns a description of the regression, or "" if there is none
+std::string compare(const Result& r, const Result& b, double tolerance) {
+    std::ostringstream oss;
+    if (r.nodes != b.nodes || r.reduced != b.reduced) {
+        oss << " size " << r.nodes << "/" << r.reduced << " (baseline "
+            << b.nodes << "/" << b.reduced << ")";
+    }
+    if (r.solutions != b.solutions) {
+        oss << " solutions " << r.solutions << " (baseline " << b.solutions
+            << ")";
+    }
+    // differences below the floors are noise
+    if (r.seconds > b.seconds * (1 + tolerance) && r.seconds - b.seconds > 0.05) {
+        oss << " time " << r.seconds << "s (baseline " << b.seconds << "s)";
+    }
+    if (r.maxrss > b.maxrss * (1 + tolerance) && r.maxrss - b.maxrss > 8192) {
+        oss << " maxrss " << r.maxrss << "KB (baseline " << b.maxrss << "KB)";
+    }
+    return oss.str();
+}
+
+int main(int argc, char** argv) {
+    std::string out_filename = "bench/results.tsv";
+    std::string baseline_filename;
+    std::string filter;
+    double tolerance = 0.25;
+    bool update_baseline = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 6, "--out=") == 0) {
+            out_filename = arg.substr(6);
+        } else if (arg.compare(0, 11, "--baseline=") == 0) {
+            baseline_filename = arg.substr(11);
+        } else if (arg.compare(0, 12, "--tolerance=") == 0) {
+            tolerance = atof(arg.c_str() + 12);
+        } else if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = arg.substr(9);
+        } else if (arg == "--update-baseline") {
+            update_baseline = true;
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (update_baseline) {
+        if (baseline_filename.empty()) {
+            std::cerr << "--update-baseline needs --baseline" << std::endl;
+            return 1;
+        }
+        out_filename = baseline_filename;
+    }
+
+    std::map<std::string,Result> baseline;
+    if (!baseline_filename.empty() && !update_baseline) {
+        baseline = readBaseline(baseline_filename);
+    }
+
+    std::ofstream fout(out_filename.c_str());
+    if (!fout) {
+        std::cerr << "cannot write " << out_filename << std::endl;
+        return 1;
+    }
+    fout << "# case\tvertices\tedges\tnodes\treduced\tsolutions\tseconds"
+            "\tmaxrss_kb\n";
+
+    int regressions = 0;
+    for (const Family* f = FAMILIES; f->name != 0; ++f) {
+        std::istringstream kinds(f->kinds);
+        std::string kind;
+        while (kinds >> kind) {
+            std::string name = std::string(f->name) + "/" + kind;
+            if (name.find(filter) == std::string::npos) continue;
+
+            std::string line = runIsolated(f->name, kind);
+            Result r;
+            if (line.compare(0, 6, "ERROR ") == 0 || !r.fromLine(line)) {
+                std::cout << "FAIL\t" << name << "\t" << line << std::endl;
+                ++regressions;
+                continue;
+            }
+            fout << line << "\n";
+            fout.flush();
+
+            std::string verdict = "ok";
+            std::map<std::string,Result>::const_iterator b =
+                    baseline.find(name);
+            if (b != baseline.end()) {
+                std::string diff = compare(r, b->second, tolerance);
+                if (!diff.empty()) {
+                    verdict = "REGRESSION" + diff;
+                    ++regressions;
+                }
+            } else if (!baseline_filename.empty() && !update_baseline) {
+                verdict = "new";
+            }
+            std::cout << name << "\t" << r.reduced << " nodes\t" << r.seconds
+                      << "s\t" << r.maxrss << "KB\t" << verdict << std::endl;
+        }
+    }
+
+    if (regressions > 0) {
+        std::cout << regressions << " case(s) regressed or failed"
+                  << std::endl;
+        return 1;
+    }
+    return 0;
+}
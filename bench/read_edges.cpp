@@ -0,0 +1,57 @@
+// Benchmark of Graph::readEdges on a large synthetic edge list.
+//
+// Usage: bench/read_edges [file [number of edges [number of vertices]]]
+//
+// If the file does not exist, it is generated with the given number
+// of edges (default: 10000000) between random vertices with integer names
+// (default: 60000 vertices).
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "tdzdd/util/Graph.hpp"
+#include "tdzdd/util/ResourceUsage.hpp"
+
+using namespace tdzdd;
+
+void generateEdgeList(const std::string& filename, long m, int n) {
+    FILE* fp = fopen(filename.c_str(), "w");
+    if (fp == NULL) {
+        std::cerr << "cannot write " << filename << std::endl;
+        exit(1);
+    }
+    unsigned long long x = 88172645463325252ULL;
+    for (long i = 0; i < m; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        int u = (x >> 32) % n + 1;
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        int v = (x >> 32) % n + 1;
+        fprintf(fp, "%d %d\n", u, v);
+    }
+    fclose(fp);
+}
+
+int main(int argc, char** argv) {
+    std::string filename = (argc > 1) ? argv[1] : "/tmp/read_edges_bench.txt";
+    long m = (argc > 2) ? atol(argv[2]) : 10000000L;
+    int n = (argc > 3) ? atoi(argv[3]) : 60000;
+
+    if (!std::ifstream(filename.c_str())) {
+        std::cerr << "generating " << filename << " ..." << std::endl;
+        generateEdgeList(filename, m, n);
+    }
+
+    ResourceUsage before;
+    Graph graph;
+    graph.readEdges(filename);
+    ResourceUsage usage = ResourceUsage() - before;
+
+    std::cout << "vertices\t" << graph.vertexSize() << "\n";
+    std::cout << "edges\t" << graph.edgeSize() << "\n";
+    std::cout << "elapsed\t" << usage.etime << "\n";
+    std::cout << "maxrss_kb\t" << ResourceUsage().maxrss << std::endl;
+    return 0;
+}
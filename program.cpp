@@ -1,12 +1,21 @@
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <set>
 #include <string>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include "tdzdd/DdSpec.hpp"
 #include "tdzdd/DdEval.hpp"
 #include "tdzdd/eval/Cardinality.hpp"
+#include "tdzdd/eval/Probability.hpp"
+#include "tdzdd/eval/SizeDistribution.hpp"
 #include "tdzdd/DdStructure.hpp"
+#include "tdzdd/DdForest.hpp"
 #include "tdzdd/util/Graph.hpp"
+#include "tdzdd/util/ModularNumber.hpp"
 
 using namespace tdzdd;
 
@@ -21,29 +30,36 @@ using namespace tdzdd;
 #include "FrontierDegreeDistribution.hpp"
 
 #include "EnumSubgraphs.hpp"
+#include "EdgeProbability.hpp"
+#include "GraphBinary.hpp"
+#include "GraphGenerator.hpp"
+#include "SubgraphKind.hpp"
+#include "BatchJobs.hpp"
 
 
-std::string getVertex(int i, int j) {
-    std::ostringstream oss;
-    oss << i << ":" << j;
-    return oss.str();
-}
+int main(int argc, char** argv) {
+#ifdef PRUNE_COUNTER
+    PruneCounter::reportAtExit();
+#endif
 
-void makeGridGraph(tdzdd::Graph& graph, int n) {
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            if (j < n - 1) {
-                graph.addEdge(getVertex(i, j), getVertex(i, j + 1));
-            }
-            if (i < n - 1) {
-                graph.addEdge(getVertex(i, j), getVertex(i + 1, j));
-            }
+    if (argc >= 2 && std::string(argv[1]) == std::string("convert")) {
+        if (argc != 4) {
+            std::cerr << "usage: " << argv[0]
+                      << " convert <edge file>|--gen=<spec> <binary file>" << std::endl;
+            return 1;
+        }
+        tdzdd::Graph graph;
+        if (std::string(argv[2]).compare(0, 6, "--gen=") == 0) {
+            GraphGenerator::generate(graph, argv[2] + 6);
+        } else {
+            graph.readEdges(argv[2]);
         }
+        FrontierManager fm(graph);
+        GraphBinary::write(argv[3], graph, fm);
+        std::cerr << "# of vertices = " << graph.vertexSize() << std::endl;
+        std::cerr << "# of edges = " << graph.edgeSize() << std::endl;
+        return 0;
     }
-    graph.update();
-}
-
-int main(int argc, char** argv) {
 
     if (argc == 1) {
         // from https://oeis.org/A140517
@@ -54,13 +70,13 @@ int main(int argc, char** argv) {
 
         for (int n = 2; n <= 10; ++n) {
             tdzdd::Graph graph;
-            makeGridGraph(graph, n);
+            GraphGenerator::grid(graph, n, n);
             FrontierManager fm(graph);
-            FrontierSingleCycleSpec spec(graph);
+            FrontierSingleCycleSpec spec(graph, &fm);
             DdStructure<2> dd(spec);
-            std::cerr << "n = " << n << ", # of solutions = "
-                      << dd.zddCardinality();
-            if (dd.zddCardinality() != solutions[n]) {
+            std::string cardinality = dd.zddCardinality();
+            std::cerr << "n = " << n << ", # of solutions = " << cardinality;
+            if (cardinality != solutions[n]) {
                 std::cerr << ", which is different from expected number "
                           << solutions[n] << ".";
             }
@@ -68,61 +84,37 @@ int main(int argc, char** argv) {
         }
     } else {
         tdzdd::Graph graph;
-        bool is_path = false;
-        bool is_ham_path = false;
-        bool is_cycle = false;
-        bool is_ham_cycle = false;
-        bool is_path_m = false;
-        bool is_ham_path_m = false;
-        bool is_cycle_m = false;
-        bool is_ham_cycle_m = false;
-
-        bool is_forest = false;
-        bool is_tree = false;
-        bool is_stree = false;
-        bool is_matching = false;
-        bool is_cmatching = false;
-        bool is_letter_I = false;
-        bool is_letter_P = false;
+        std::string kind;
 
         bool is_dot = false;
         bool is_show_fs = false;
         bool is_enum = false;
+        bool is_size_dist = false;
+        int max_size = -1;
+        std::string prob_filename;
+        std::string checkpoint_filename;
+        std::string resume_filename;
+        std::string stats_filename;
+        size_t memory_budget_mb = 0;
+        bool is_reduce = false;
+        bool is_lookahead = false;
+        size_t depth_first_memo = 0;
+        bool is_hybrid = false;
+        bool is_find_one = false;
+        uint64_t checkpoint_interval = 1000000;
+
+        std::string graph_filename;
+        std::string gen_spec;
+        std::string batch_filename;
+        std::string pairs_filename;
+        std::string s_name = "1";
+        std::string t_name;
 
         bool readfirst = false;
         for (int i = 1; i < argc; ++i) {
-            if (std::string(argv[i]) == std::string("--path")) {
-                is_path = true;
-            } else if (std::string(argv[i]) == std::string("--hampath")) {
-                is_ham_path = true;
-            } else if (std::string(argv[i]) == std::string("--cycle") ||
-                       std::string(argv[i]) == std::string("--letter_O")) {
-                is_cycle = true;
-            } else if (std::string(argv[i]) == std::string("--hamcycle")) {
-                is_ham_cycle = true;
-            } else if (std::string(argv[i]) == std::string("--path_m")) {
-                is_path_m = true;
-            } else if (std::string(argv[i]) == std::string("--hampath_m")) {
-                is_ham_path_m = true;
-            } else if (std::string(argv[i]) == std::string("--cycle_m")) {
-                is_cycle_m = true;
-            } else if (std::string(argv[i]) == std::string("--hamcycle_m")) {
-                is_ham_cycle_m = true;
-            } else if (std::string(argv[i]) == std::string("--forest")) {
-                is_forest = true;
-            } else if (std::string(argv[i]) == std::string("--tree")) {
-                is_tree = true;
-            } else if (std::string(argv[i]) == std::string("--stree")) {
-                is_stree = true;
-            } else if (std::string(argv[i]) == std::string("--matching")) {
-                is_matching = true;
-            } else if (std::string(argv[i]) == std::string("--cmatching")) {
-                is_cmatching = true;
-            } else if (std::string(argv[i]) == std::string("--letter_I") ||
-                       std::string(argv[i]) == std::string("--letter_L")) {
-                is_letter_I = true;
-            } else if (std::string(argv[i]) == std::string("--letter_P")) {
-                is_letter_P = true;
+            if (argv[i][0] == '-' && argv[i][1] == '-'
+                && SubgraphKind::isKind(argv[i] + 2)) {
+                kind = argv[i] + 2;
             } else if (std::string(argv[i]) == std::string("--show")) {
                 tdzdd::MessageHandler::showMessages(true);
             } else if (std::string(argv[i]) == std::string("--dot")) {
@@ -131,13 +123,62 @@ int main(int argc, char** argv) {
                 is_show_fs = true;
             } else if (std::string(argv[i]) == std::string("--enum")) {
                 is_enum = true;
+            } else if (std::string(argv[i]) == std::string("--size-dist")) {
+                is_size_dist = true;
+            } else if (std::string(argv[i]).compare(0, 12, "--size-dist=") == 0) {
+                is_size_dist = true;
+                max_size = atoi(argv[i] + 12);
+            } else if (std::string(argv[i]).compare(0, 7, "--prob=") == 0) {
+                prob_filename = argv[i] + 7;
+            } else if (std::string(argv[i]).compare(0, 13, "--checkpoint=") == 0) {
+                checkpoint_filename = argv[i] + 13;
+            } else if (std::string(argv[i]).compare(0, 22, "--checkpoint-interval=") == 0) {
+                checkpoint_interval = strtoull(argv[i] + 22, NULL, 10);
+            } else if (std::string(argv[i]).compare(0, 9, "--resume=") == 0) {
+                resume_filename = argv[i] + 9;
+            } else if (std::string(argv[i]) == std::string("--reduce")) {
+                is_reduce = true;
+            } else if (std::string(argv[i]) == std::string("--lookahead")) {
+                is_lookahead = true;
+            } else if (std::string(argv[i]) == std::string("--find-one")) {
+                is_find_one = true;
+            } else if (std::string(argv[i]).compare(0, 14, "--depth-first=") == 0) {
+                depth_first_memo = strtoull(argv[i] + 14, NULL, 10);
+                is_hybrid = false;
+            } else if (std::string(argv[i]).compare(0, 9, "--hybrid=") == 0) {
+                depth_first_memo = strtoull(argv[i] + 9, NULL, 10);
+                is_hybrid = true;
+            } else if (std::string(argv[i]).compare(0, 16, "--memory-budget=") == 0) {
+                memory_budget_mb = strtoull(argv[i] + 16, NULL, 10);
+            } else if (std::string(argv[i]).compare(0, 8, "--sweep=") == 0) {
+                SweepPolicy* policy = 0;
+                try {
+                    policy = SweepPolicy::create(argv[i] + 8);
+                } catch (std::runtime_error& e) {
+                    std::cerr << e.what() << std::endl;
+                    return 1;
+                }
+                SweepPolicy::setDefault(*policy);
+                delete policy;
+            } else if (std::string(argv[i]).compare(0, 8, "--stats=") == 0) {
+                stats_filename = argv[i] + 8;
+            } else if (std::string(argv[i]).compare(0, 6, "--gen=") == 0) {
+                gen_spec = argv[i] + 6;
+            } else if (std::string(argv[i]).compare(0, 8, "--batch=") == 0) {
+                batch_filename = argv[i] + 8;
+            } else if (std::string(argv[i]).compare(0, 11, "--st-pairs=") == 0) {
+                pairs_filename = argv[i] + 11;
+            } else if (std::string(argv[i]).compare(0, 4, "--s=") == 0) {
+                s_name = argv[i] + 4;
+            } else if (std::string(argv[i]).compare(0, 4, "--t=") == 0) {
+                t_name = argv[i] + 4;
             } else if (argv[i][0] == '-') {
                 std::cerr << "unknown option " << argv[i] << std::endl;
                 return 1;
             } else {
                 if (!readfirst) {
                     readfirst = true;
-                    graph.readEdges(argv[i]);
+                    graph_filename = argv[i];
                 } else {
                     std::cerr << "illegal argument " << argv[i] << std::endl;
                     return 1;
@@ -145,7 +186,34 @@ int main(int argc, char** argv) {
             }
         }
 
-        FrontierManager fm(graph);
+        if (!batch_filename.empty()) {
+            BatchJobs jobs(batch_filename);
+            return jobs.run(std::cout) == 0 ? 0 : 1;
+        }
+        if (!pairs_filename.empty()) {
+            if (kind.empty() || !readfirst) {
+                std::cerr << "--st-pairs needs a kind of paths and a graph."
+                          << std::endl;
+                return 1;
+            }
+            BatchJobs jobs;
+            jobs.addPairJobs(graph_filename, kind, pairs_filename);
+            return jobs.run(std::cout) == 0 ? 0 : 1;
+        }
+
+        // a binary graph made by "convert" also holds the frontier plan
+        std::vector<int> plan;
+        if (readfirst) {
+            if (GraphBinary::isGraphBinary(graph_filename)) {
+                GraphBinary::read(graph_filename, graph, plan);
+            } else {
+                graph.readEdges(graph_filename);
+            }
+        } else if (!gen_spec.empty()) {
+            GraphGenerator::generate(graph, gen_spec);
+        }
+        const FrontierManager fm = plan.empty() ? FrontierManager(graph) :
+                                   FrontierManager(graph, plan);
 
         std::cerr << "# of vertices = " << graph.vertexSize() << std::endl;
         std::cerr << "# of edges = " << graph.edgeSize() << std::endl;
@@ -154,79 +222,107 @@ int main(int argc, char** argv) {
             fm.print();
         }
 
-        DdStructure<2> dd;
-
-        std::ostringstream oss;
-        oss << graph.vertexSize();
-        const int endPoint = graph.getVertex(oss.str());
-
-        if (is_path) {
-            FrontierSTPathSpec spec(graph, false, graph.getVertex("1"), endPoint);
-            dd = DdStructure<2>(spec);
-        } else if (is_ham_path) {
-            FrontierSTPathSpec spec(graph, true, graph.getVertex("1"), endPoint);
-            dd = DdStructure<2>(spec);
-        } else if (is_cycle) {
-            FrontierSingleCycleSpec spec(graph);
-            dd = DdStructure<2>(spec);
-        } else if (is_ham_cycle) {
-            FrontierSingleHamiltonianCycleSpec spec(graph);
-            dd = DdStructure<2>(spec);
-        } else if (is_path_m) {
-            FrontierMateSpec spec(graph, false, graph.getVertex("1"), endPoint);
-            dd = DdStructure<2>(spec);
-        } else if (is_ham_path_m) {
-            FrontierMateSpec spec(graph, true, graph.getVertex("1"), endPoint);
-            dd = DdStructure<2>(spec);
-        } else if (is_cycle_m) {
-            FrontierMateSpec spec(graph, false);
-            dd = DdStructure<2>(spec);
-        } else if (is_ham_cycle_m) {
-            FrontierMateSpec spec(graph, true);
-            dd = DdStructure<2>(spec);
-        } else if (is_forest) {
-            FrontierForestSpec spec(graph);
-            dd = DdStructure<2>(spec);
-        } else if (is_tree) {
-            FrontierTreeSpec spec(graph, false);
-            dd = DdStructure<2>(spec);
-        } else if (is_stree) {
-            FrontierTreeSpec spec(graph, true);
-            dd = DdStructure<2>(spec);
-        } else if (is_matching) {
-            FrontierMatchingSpec spec(graph, false);
-            dd = DdStructure<2>(spec);
-        } else if (is_cmatching) {
-            FrontierMatchingSpec spec(graph, true);
-            dd = DdStructure<2>(spec);
-        } else if (is_letter_I) {
-            std::vector<IntSubset*> degRanges;
-            degRanges.push_back(new IntRange(0, INT_MAX));
-            degRanges.push_back(new IntRange(2, 2));
-            degRanges.push_back(new IntRange(0, INT_MAX));
-            FrontierDegreeDistributionSpec spec(graph, degRanges, true);
-            dd = DdStructure<2>(spec);
-        } else if (is_letter_P) {
-            std::vector<IntSubset*> degRanges;
-            degRanges.push_back(new IntRange(0, INT_MAX));
-            degRanges.push_back(new IntRange(1, 1));
-            degRanges.push_back(new IntRange(0, INT_MAX));
-            degRanges.push_back(new IntRange(1, 1));
-            FrontierDegreeDistributionSpec spec(graph, degRanges, true);
-            dd = DdStructure<2>(spec);
-        } else {
+        if (kind.empty()) {
             std::cerr << "Please specify a kind of subgraphs." << std::endl;
             exit(1);
         }
 
+        int s = 0;
+        int t = 0;
+        if (SubgraphKind::hasTerminals(kind)) {
+            s = graph.getVertex(s_name);
+            t = graph.getVertex(t_name.empty() ?
+                                tdzdd::to_string(graph.vertexSize()) : t_name);
+        }
+
+        if (is_find_one) {
+            // a portfolio of searches runs on all the threads
+            std::vector<std::pair<int, int> > instance;
+            if (!SubgraphKind::findOne(kind, graph, fm, s, t, instance,
+                                       true)) {
+                std::cerr << "# of solutions = 0" << std::endl;
+                return 0;
+            }
+            std::cerr << "# of solutions >= 1" << std::endl;
+            std::set<int> levels;
+            for (size_t k = 0; k < instance.size(); ++k) {
+                if (instance[k].second != 0) {
+                    levels.insert(instance[k].first);
+                }
+            }
+            for (int i = graph.edgeSize(); i >= 1; --i) {
+                std::cout << (levels.count(i) > 0 ? "1" : "0");
+                if (i > 1) {
+                    std::cout << " ";
+                }
+            }
+            std::cout << std::endl;
+            return 0;
+        }
+
+        if (!stats_filename.empty()) {
+            RunStatistics::enable();
+        }
+
+        DdStructure<2> dd;
+        if (depth_first_memo > 0) {
+            DepthFirstMode mode(depth_first_memo, is_hybrid);
+            SubgraphKind::construct(kind, graph, fm, s, t, dd, NULL, false,
+                                    is_lookahead, &mode);
+        } else if (memory_budget_mb > 0) {
+            // the states of all the frontier specs are plain bytes
+            MemoryBudget budget(memory_budget_mb << 20, true);
+            try {
+                SubgraphKind::construct(kind, graph, fm, s, t, dd, &budget,
+                                        is_reduce, is_lookahead);
+            } catch (MemoryBudgetExceeded& e) {
+                std::cerr << e.what() << std::endl;
+                std::cerr << e.report();
+                return 2;
+            }
+        } else {
+            SubgraphKind::construct(kind, graph, fm, s, t, dd, NULL,
+                                    is_reduce, is_lookahead);
+        }
+
+        if (!stats_filename.empty()) {
+            RunStatistics::enable(false);
+            RunStatistics::write(stats_filename);
+        }
         std::cerr << "# of ZDD nodes = " << dd.size() << std::endl;
         std::cerr << "# of solutions = " << dd.zddCardinality() << std::endl;
 
+        if (!prob_filename.empty()) {
+            EdgeProbability ep(graph);
+            ep.readProbabilities(prob_filename);
+            double p = dd.evaluate(ZddProbability<double>(
+                ep.getLevelProbabilities<double>()));
+            ModularNumber<> pm = dd.evaluate(ZddProbability<ModularNumber<> >(
+                ep.getLevelProbabilities<ModularNumber<> >()));
+            std::cerr << "probability = " << std::setprecision(17) << p
+                      << std::endl;
+            std::cerr << "probability mod 998244353 = " << pm << std::endl;
+        }
+        if (is_size_dist) {
+            std::vector<std::string> dist = dd.zddSizeDistribution(max_size);
+            std::cout << "# size\tcount" << std::endl;
+            for (size_t k = 0; k < dist.size(); ++k) {
+                if (dist[k] != "0") {
+                    std::cout << k << "\t" << dist[k] << std::endl;
+                }
+            }
+        }
         if (is_dot) {
             dd.dumpDot(std::cout);
         }
         if (is_enum) {
-            EnumSubgraphs::enumSubgraphs(std::cout, graph, dd);
+            if (checkpoint_filename.empty() && resume_filename.empty()) {
+                EnumSubgraphs::enumSubgraphs(std::cout, graph, dd);
+            } else {
+                EnumSubgraphs::enumSubgraphsWithCheckpoint(std::cout, graph,
+                    dd, checkpoint_filename, checkpoint_interval,
+                    resume_filename);
+            }
         }
     }
 
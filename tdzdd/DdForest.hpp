@@ -0,0 +1,245 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "DdStructure.hpp"
+#include "dd/CountTable.hpp"
+#include "dd/DataTable.hpp"
+#include "dd/Node.hpp"
+#include "dd/NodeTable.hpp"
+#include "util/MessageHandler.hpp"
+#include "util/MyHashTable.hpp"
+#include "util/MyVector.hpp"
+
+namespace tdzdd {
+
+/**
+ * Collection of decision diagrams stored in one node table.
+ * Each diagram added is hash-consed into the shared table level by level,
+ * so that a sub-diagram common to several diagrams is stored only once.
+ * The diagrams should be reduced in the same way before being added,
+ * and they stay reduced in the shared table.
+ * @tparam ARITY arity of the nodes.
+ */
+template<int ARITY>
+class DdForest {
+    typedef MyHashMap<InitializedNode<ARITY>,size_t> UniqTable;
+
+    NodeTableHandler<ARITY> diagram; ///< The shared diagram structure.
+    std::vector<NodeId> roots;       ///< Root node IDs.
+    MyVector<UniqTable> uniq;        ///< Unique tables for each level.
+    bool useMP;                      ///< Flag to use MP algorithms.
+
+    /*
+     * Makes the unique table of level i cover all nodes at the level.
+     */
+    UniqTable& uniqueTable(int i) {
+        NodeTableEntity<ARITY> const& table = *diagram;
+        size_t const m = table[i].size();
+        assert(size_t(i) < uniq.size());
+        UniqTable& u = uniq[i];
+        if (u.size() < m) {
+            u.initialize(m * 2);
+            for (size_t j = 0; j < m; ++j) {
+                u[table[i][j]] = j;
+            }
+        }
+        return u;
+    }
+
+public:
+    /**
+     * Default constructor.
+     * @param useMP use algorithms for multiple processors.
+     */
+    DdForest(bool useMP = false) :
+            useMP(useMP) {
+    }
+
+    /**
+     * Adds a diagram.
+     * Only the nodes reachable from its root are copied.
+     * @param dd the diagram.
+     * @return the index of the diagram in this forest.
+     */
+    size_t add(DdStructure<ARITY> const& dd) {
+        NodeTableEntity<ARITY> const& input = *dd.getDiagram();
+        NodeId const root = dd.root();
+        int const n = root.row();
+
+        MessageHandler mh;
+        mh.begin("sharing");
+        mh.setSteps(n);
+
+        NodeTableEntity<ARITY>& table = diagram.privateEntity();
+        if (table.numRows() <= n) table.setNumRows(n + 1);
+        table.deleteIndex();
+        if (uniq.size() <= size_t(n)) {
+            // copying hash tables enlarges them; rebuild them instead
+            uniq.clear();
+            uniq.resize(n + 1);
+        }
+
+        // Mark the reachable nodes
+        DataTable<NodeId> newId(n + 1);
+        NodeId const unused(NODE_ROW_MAX, NODE_COL_MAX);
+        for (int i = 1; i <= n; ++i) {
+            size_t const m = input[i].size();
+            newId[i].resize(m);
+            for (size_t j = 0; j < m; ++j) {
+                newId[i][j] = unused;
+            }
+        }
+        newId[0].resize(2);
+        newId[0][0] = 0;
+        newId[0][1] = 1;
+        if (n >= 1) newId[n][root.col()] = 0;
+        for (int i = n; i >= 1; --i) {
+            size_t const m = input[i].size();
+            for (size_t j = 0; j < m; ++j) {
+                if (newId[i][j] == unused) continue;
+                for (int b = 0; b < ARITY; ++b) {
+                    NodeId f = input.child(i, j, b);
+                    if (f.row() >= 1) newId[f.row()][f.col()] = 0;
+                }
+            }
+        }
+
+        // Copy the marked nodes bottom-up, sharing equivalent ones
+        for (int i = 1; i <= n; ++i) {
+            size_t const m = input[i].size();
+            UniqTable& u = uniqueTable(i);
+
+            for (size_t j = 0; j < m; ++j) {
+                if (newId[i][j] == unused) continue;
+                InitializedNode<ARITY> node;
+                for (int b = 0; b < ARITY; ++b) {
+                    NodeId f = input.child(i, j, b);
+                    NodeId g = newId[f.row()][f.col()];
+                    node.branch[b] = NodeId(g.row(), g.col(), f.getAttr());
+                }
+
+                size_t* p = u.getValue(node);
+                size_t k;
+                if (p != 0) {
+                    k = *p;
+                }
+                else {
+                    k = table.addColumn(i);
+                    table[i][k] = node;
+                    u[node] = k;
+                }
+                newId[i][j] = NodeId(i, k);
+            }
+
+            mh.step();
+        }
+
+        NodeId g = newId[n][root.col()];
+        roots.push_back(NodeId(g.row(), g.col(), root.getAttr()));
+        mh.end(size());
+        return roots.size() - 1;
+    }
+
+    /**
+     * Gets the number of diagrams.
+     * @return the number of diagrams.
+     */
+    size_t numRoots() const {
+        return roots.size();
+    }
+
+    /**
+     * Gets the root node of a diagram.
+     * @param k the index of the diagram.
+     * @return root node ID.
+     */
+    NodeId root(size_t k) const {
+        assert(k < roots.size());
+        return roots[k];
+    }
+
+    /**
+     * Gets a diagram as a DdStructure that refers to the shared table.
+     * The node table is not copied until either of them is modified.
+     * @param k the index of the diagram.
+     * @return the diagram.
+     */
+    DdStructure<ARITY> get(size_t k) const {
+        assert(k < roots.size());
+        return DdStructure<ARITY>(diagram, roots[k], useMP);
+    }
+
+    /**
+     * Gets the shared diagram.
+     * @return the node table handler.
+     */
+    NodeTableHandler<ARITY> const& getDiagram() const {
+        return diagram;
+    }
+
+    /**
+     * Gets the number of nonterminal nodes in the shared table.
+     * @return the number of nonterminal nodes.
+     */
+    size_t size() const {
+        return diagram->size();
+    }
+
+    /**
+     * Releases the unique tables used for adding diagrams.
+     * They are rebuilt when another diagram is added.
+     */
+    void dropUniqueTables() {
+        uniq.clear();
+    }
+
+    /**
+     * Counts the number of sets in the family of sets represented by
+     * each diagram as a ZDD, visiting every shared node once.
+     * @return the numbers of itemsets indexed by the diagrams.
+     */
+    std::vector<std::string> zddCardinalities() const {
+        MessageHandler mh;
+        mh.begin("counting");
+        CountTable<ARITY> counts;
+        counts.build(*diagram, NodeId(diagram->numRows() - 1, 0), useMP);
+
+        std::vector<std::string> result(roots.size());
+        for (size_t k = 0; k < roots.size(); ++k) {
+            result[k] = counts.get(roots[k]);
+        }
+        mh.end();
+        return result;
+    }
+};
+
+} // namespace tdzdd
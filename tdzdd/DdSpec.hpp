@@ -30,6 +30,7 @@
 
 #include "dd/DdBuilder.hpp"
 #include "dd/DepthFirstSearcher.hpp"
+#include "dd/FeasibilitySearcher.hpp"
 #include "util/demangle.hpp"
 #include "util/MessageHandler.hpp"
 
@@ -52,6 +53,7 @@ namespace tdzdd {
  *
  * Optionally, the following functions can be overloaded:
  * - void printLevel(std::ostream& os, int level) const
+ * - bool is_forced_zero(void const* p, int level) const
  *
  * A return code of get_root(void*) or get_child(void*, int, bool) is:
  * 0 when the node is the 0-terminal, -1 when it is the 1-terminal, or
@@ -60,6 +62,12 @@ namespace tdzdd {
  * merged into the first one, 1 when they cannot be merged and the first
  * one should be forwarded to the 0-terminal, 2 when they cannot be merged
  * and the second one should be forwarded to the 0-terminal.
+ * is_forced_zero(void const*, int) returns true only if no branch but
+ * the 0-branch of the node at the level leads to the 1-terminal;
+ * it must be cheap, since it is a hint for ZddSkipForced and ZddLookahead
+ * to skip the level without copying the state.
+ * The derived spec classes forward it to isForcedZero on their states,
+ * which returns false by default.
  *
  * @tparam S the class implementing this class.
  * @tparam AR arity of the nodes.
@@ -81,6 +89,10 @@ public:
         os << level;
     }
 
+    bool is_forced_zero(void const* p, int level) const {
+        return false;
+    }
+
     /**
      * Returns a random instance using simple depth-first search
      * without caching.
@@ -93,6 +105,24 @@ public:
         return DepthFirstSearcher<S>(entity()).findOneInstance();
     }
 
+    /**
+     * Returns an instance using depth-first search that learns
+     * the dead states, which also proves that no instance exists.
+     * merge_states(void*, void*) is not supported.
+     * @param useMP run a portfolio of searches on multiple processors.
+     * @return a collection of (item, value) pairs.
+     * @exception std::runtime_error no instance exists.
+     * @see FeasibilitySearcher
+     */
+    std::vector<std::pair<int,int> > findFeasibleInstance(
+            bool useMP = false) const {
+        std::vector<std::pair<int,int> > instance;
+        if (!FeasibilitySearcher<S>(entity(), useMP).search(instance)) {
+            throw std::runtime_error("No instance");
+        }
+        return instance;
+    }
+
     /**
      * Dumps the diagram in Graphviz (DOT) format.
      * @param os the output stream.
@@ -187,6 +217,7 @@ protected:
  *
  * Optionally, the following functions can be overloaded:
  * - void printLevel(std::ostream& os, int level) const
+ * - bool isForcedZero(int level) const
  *
  * @tparam S the class implementing this class.
  * @tparam AR arity of the nodes.
@@ -207,6 +238,14 @@ public:
         return this->entity().getChild(level, value);
     }
 
+    bool isForcedZero(int level) const {
+        return false;
+    }
+
+    bool is_forced_zero(void const* p, int level) const {
+        return this->entity().isForcedZero(level);
+    }
+
     void get_copy(void* to, void const* from) {
     }
 
@@ -247,6 +286,7 @@ public:
  * - size_t hashCode(T const& state) const
  * - bool equalTo(T const& state1, T const& state2) const
  * - void printLevel(std::ostream& os, int level) const
+ * - bool isForcedZero(T const& state, int level) const
  * - void printState(std::ostream& os, State const& s) const
  *
  * @tparam S the class implementing this class.
@@ -286,6 +326,14 @@ public:
         return this->entity().getChild(state(p), level, value);
     }
 
+    bool isForcedZero(State const& s, int level) const {
+        return false;
+    }
+
+    bool is_forced_zero(void const* p, int level) const {
+        return this->entity().isForcedZero(state(p), level);
+    }
+
     void getCopy(void* p, State const& s) {
         new (p) State(s);
     }
@@ -363,6 +411,7 @@ public:
  * - size_t hashCode(T const* state) const
  * - bool equalTo(T const* state1, T const* state2) const
  * - void printLevel(std::ostream& os, int level) const
+ * - bool isForcedZero(T const* array, int level) const
  * - void printState(std::ostream& os, State const* array) const
  *
  * @tparam S the class implementing this class.
@@ -423,6 +472,14 @@ public:
         return this->entity().getChild(state(p), level, value);
     }
 
+    bool isForcedZero(State const* a, int level) const {
+        return false;
+    }
+
+    bool is_forced_zero(void const* p, int level) const {
+        return this->entity().isForcedZero(state(p), level);
+    }
+
     void get_copy(void* to, void const* from) {
         Word const* pa = static_cast<Word const*>(from);
         Word const* pz = pa + dataWords;
@@ -515,6 +572,7 @@ public:
  * - size_t hashCode(TS const& state) const
  * - bool equalTo(TS const& state1, TS const& state2) const
  * - void printLevel(std::ostream& os, int level) const
+ * - bool isForcedZero(TS const& s, TA const* a, int level) const
  * - void printState(std::ostream& os, TS const& s, TA const* a) const
  *
  * @tparam S the class implementing this class.
@@ -588,6 +646,14 @@ public:
         return this->entity().getChild(s_state(p), a_state(p), level, value);
     }
 
+    bool isForcedZero(S_State const& s, A_State const* a, int level) const {
+        return false;
+    }
+
+    bool is_forced_zero(void const* p, int level) const {
+        return this->entity().isForcedZero(s_state(p), a_state(p), level);
+    }
+
     void getCopy(void* p, S_State const& s) {
         new (p) S_State(s);
     }
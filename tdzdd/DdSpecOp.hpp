@@ -44,6 +44,7 @@ BddAnd<S1,S2> bddAnd(S1 const& spec1, S2 const& spec2) {
 #if __cplusplus >= 201103L
 /**
  * Returns a BDD specification for logical AND of two or more BDD specifications.
+ * The states of the specifications are stored side by side in one array.
  * (since C++11)
  * @param specs BDD specifications.
  * @return BDD specification for logical AND of @p specs.
@@ -92,6 +93,7 @@ ZddIntersection<S1,S2> zddIntersection(S1 const& spec1, S2 const& spec2) {
 #if __cplusplus >= 201103L
 /**
  * Returns a ZDD specification for set intersection of two or more ZDD specifications.
+ * The states of the specifications are stored side by side in one array.
  * (since C++11)
  * @param specs ZDD specifications.
  * @return ZDD specification for set intersection of @p specs.
@@ -146,6 +148,19 @@ ZddLookahead<S> zddLookahead(S const& spec) {
     return ZddLookahead<S>(spec);
 }
 
+/**
+ * Skips the levels where only the 0-branch of a ZDD specification can
+ * lead to the 1-terminal, according to its is_forced_zero hook.
+ * Unlike zddLookahead, no state is copied to try the other branches.
+ * @param spec original ZDD specification.
+ * @param enabled false to leave the specification as it is.
+ * @return optimized ZDD specification.
+ */
+template<typename S>
+ZddSkipForced<S> zddSkipForced(S const& spec, bool enabled = true) {
+    return ZddSkipForced<S>(spec, enabled);
+}
+
 /**
  * Creates a QDD specification from a BDD specification by complementing
  * skipped nodes in terms of the BDD node deletion rule.
@@ -34,14 +34,19 @@
 
 #include "DdEval.hpp"
 #include "DdSpec.hpp"
+#include "dd/CountTable.hpp"
 #include "dd/DdBuilder.hpp"
 #include "dd/DdReducer.hpp"
+#include "dd/DepthFirstBuilder.hpp"
 #include "dd/Node.hpp"
 #include "dd/NodeTable.hpp"
+#include "dd/ZddApply.hpp"
 #include "eval/Cardinality.hpp"
+#include "eval/SizeDistribution.hpp"
 #include "op/Lookahead.hpp"
 #include "op/Unreduction.hpp"
 #include "util/demangle.hpp"
+#include "util/MemoryBudget.hpp"
 #include "util/MessageHandler.hpp"
 #include "util/MyHashTable.hpp"
 #include "util/MyVector.hpp"
@@ -57,13 +62,16 @@ class DdStructure: public DdSpec<DdStructure<ARITY>,NodeId,ARITY> {
     NodeTableHandler<ARITY> diagram; ///< The diagram structure.
     NodeId root_;                    ///< Root node ID.
     bool useMP;                      ///< Flag to use MP algorithms.
+    bool inPlace;                    ///< Flag to reduce in place.
+    bool cacheCounts;                ///< Flag to keep path counts.
+    mutable CountTable<ARITY> countTable; ///< Cache of path counts.
 
 public:
     /**
      * Default constructor.
      */
     DdStructure() :
-            root_(0), useMP(false) {
+            root_(0), useMP(false), inPlace(false), cacheCounts(false) {
     }
 
 //    /*
@@ -80,7 +88,8 @@ public:
      * @param useMP use algorithms for multiple processors.
      */
     DdStructure(int n, bool useMP = false) :
-            diagram(n + 1), root_(1), useMP(useMP) {
+            diagram(n + 1), root_(1), useMP(useMP), inPlace(false),
+            cacheCounts(false) {
         assert(n >= 0);
         NodeTableEntity<ARITY>& table = diagram.privateEntity();
         NodeId f(1);
@@ -96,35 +105,91 @@ public:
         root_ = f;
     }
 
+    /**
+     * Diagram view constructor.
+     * The node table is shared until either side modifies it.
+     * @param diagram the node table.
+     * @param root the root node in the table.
+     * @param useMP use algorithms for multiple processors.
+     */
+    DdStructure(NodeTableHandler<ARITY> const& diagram, NodeId root,
+            bool useMP = false) :
+            diagram(diagram), root_(root), useMP(useMP), inPlace(false),
+            cacheCounts(false) {
+        assert(root.row() < diagram->numRows());
+    }
+
     /**
      * DD construction.
+     * With @p zddReduction, the ZDD reduction rules are applied to
+     * the levels whose edges are completed while the construction,
+     * and the rest is reduced in place at the end, so that the result is
+     * the reduced ZDD without a separate zddReduce() pass.
      * @param spec DD spec.
      * @param useMP use algorithms for multiple processors.
+     * @param zddReduction reduce the ZDD on the fly.
      */
     template<typename SPEC>
-    DdStructure(DdSpecBase<SPEC,ARITY> const& spec, bool useMP = false) :
-            useMP(useMP) {
+    DdStructure(DdSpecBase<SPEC,ARITY> const& spec, bool useMP = false,
+            bool zddReduction = false) :
+            useMP(useMP), inPlace(false), cacheCounts(false) {
 #ifdef _OPENMP
-        if (useMP) constructMP_(spec.entity());
+        if (useMP) constructMP_(spec.entity(), zddReduction);
         else
 #endif
-        construct_(spec.entity());
+        construct_(spec.entity(), 0, zddReduction);
+    }
+
+    /**
+     * DD construction within a memory budget.
+     * The DD is built by the serial builder, which sweeps dead nodes
+     * early, spills pending states to a file if allowed, and finally
+     * aborts as its memory usage approaches the limit of the budget.
+     * @param spec DD spec.
+     * @param budget the memory budget.
+     * @param zddReduction reduce the ZDD on the fly.
+     * @throws MemoryBudgetExceeded if the limit is reached.
+     */
+    template<typename SPEC>
+    DdStructure(DdSpecBase<SPEC,ARITY> const& spec, MemoryBudget const& budget,
+            bool zddReduction = false) :
+            useMP(false), inPlace(false), cacheCounts(false) {
+        construct_(spec.entity(), &budget, zddReduction);
+    }
+
+    /**
+     * Depth-first ZDD construction.
+     * The reduced ZDD is built by DepthFirstBuilder, which keeps the states
+     * on the current path and a bounded memo of the states already built
+     * instead of whole levels of states.
+     * @param spec ZDD spec.
+     * @param mode the memo capacity and whether to use the hybrid mode.
+     */
+    template<typename SPEC>
+    DdStructure(DdSpecBase<SPEC,ARITY> const& spec, DepthFirstMode const& mode) :
+            useMP(false), inPlace(false), cacheCounts(false) {
+        constructDepthFirst_(spec.entity(), mode);
     }
 
 private:
     template<typename SPEC>
-    void construct_(SPEC const& spec) {
+    void construct_(SPEC const& spec, MemoryBudget const* budget = 0,
+            bool zddReduction = false) {
         MessageHandler mh;
         mh.begin(typenameof(spec));
         DdBuilder<SPEC> zc(spec, diagram);
+        if (budget) zc.setMemoryBudget(*budget);
+        if (zddReduction) zc.setZddReduction();
         int n = zc.initialize(root_);
 
         if (n > 0) {
             mh.setSteps(n);
             for (int i = n; i > 0; --i) {
                 zc.construct(i);
+                zc.checkMemory(i);
                 mh.step();
             }
+            if (zddReduction) zc.reduce();
         }
         else {
             mh << " ...";
@@ -134,10 +199,26 @@ private:
     }
 
     template<typename SPEC>
-    void constructMP_(SPEC const& spec) {
+    void constructDepthFirst_(SPEC const& spec, DepthFirstMode const& mode) {
+        MessageHandler mh;
+        mh.begin(typenameof(spec));
+        mh << (mode.hybrid ? " hybrid" : " depth-first");
+        DepthFirstBuilder<SPEC> zc(spec, diagram.privateEntity(), mode);
+        zc.construct(root_);
+        if (mode.hybrid) {
+            mh << " from level " << zc.depthFirstLevel();
+        }
+        mh << ", " << zc.memoMisses() << " built, " << zc.memoHits()
+           << " hits, " << zc.memoEvictions() << " evictions";
+        mh.end(size());
+    }
+
+    template<typename SPEC>
+    void constructMP_(SPEC const& spec, bool zddReduction = false) {
         MessageHandler mh;
         mh.begin(typenameof(spec));
         DdBuilderMP<SPEC> zc(spec, diagram);
+        if (zddReduction) zc.setZddReduction();
         int n = zc.initialize(root_);
 
         if (n > 0) {
@@ -149,6 +230,7 @@ private:
                 zc.construct(i);
                 mh.step();
             }
+            if (zddReduction) zc.reduce();
         }
         else {
             mh << " ...";
@@ -193,6 +275,7 @@ private:
         }
 
         diagram = tmpTable;
+        countTable.clear();
         mh.end(size());
     }
 
@@ -220,6 +303,7 @@ private:
         }
 
         diagram = tmpTable;
+        countTable.clear();
         mh.end(size());
     }
 
@@ -235,6 +319,52 @@ public:
         return old;
     }
 
+    /**
+     * Enables or disables the in-place reduction.
+     * In place, the reduction renumbers and compacts the nodes within
+     * the current node table level by level instead of copying them
+     * to a new one, so that it needs memory only for the new node IDs
+     * of the levels in progress.
+     * @param flag true for reducing in place.
+     * @return old value of the flag.
+     */
+    bool useInPlaceReduction(bool flag = true) {
+        bool old = inPlace;
+        inPlace = flag;
+        return old;
+    }
+
+    /**
+     * Enables or disables the cache of per-node path counts.
+     * When enabled, the counts are computed at the first call of
+     * zddCardinality(), rank(), or unrank() and reused by the later calls
+     * until the diagram is reduced or subsetted.
+     * The cache is not shared with copies of this object.
+     * @param flag true for keeping the cache.
+     * @return old value of the flag.
+     */
+    bool useCountCache(bool flag = true) {
+        bool old = cacheCounts;
+        cacheCounts = flag;
+        if (!flag) countTable.clear();
+        return old;
+    }
+
+    /**
+     * Releases the cache of per-node path counts.
+     */
+    void dropCountCache() {
+        countTable.clear();
+    }
+
+    /**
+     * Gets the memory usage of the cache of per-node path counts.
+     * @return the number of bytes used by the cache.
+     */
+    size_t countCacheMemory() const {
+        return countTable.memoryUsage();
+    }
+
     /**
      * Gets the root node.
      * @return root node ID.
@@ -396,7 +526,8 @@ public:
         if (useMP) mh << " " << omp_get_max_threads() << "x";
 #endif
 
-        DdReducer<ARITY,BDD,ZDD> zr(diagram, useMP);
+        countTable.clear();
+        DdReducer<ARITY,BDD,ZDD> zr(diagram, useMP, inPlace);
         zr.setRoot(root_);
 
         mh.setSteps(n);
@@ -429,6 +560,112 @@ public:
                         ZddUnreduction<DdStructure>(*this, numVars)), useMP);
     }
 
+    /**
+     * Computes the union of this ZDD and another.
+     * The reduced diagrams are combined directly by ZddApply
+     * instead of being traversed as specs.
+     * @param o the other ZDD on the same variables.
+     * @return the union.
+     */
+    DdStructure zddUnion(DdStructure const& o) const {
+        return zddApply_(ZddApply::UNION, o);
+    }
+
+    /**
+     * Computes the intersection of this ZDD and another.
+     * @param o the other ZDD on the same variables.
+     * @return the intersection.
+     */
+    DdStructure zddIntersection(DdStructure const& o) const {
+        return zddApply_(ZddApply::INTERSECTION, o);
+    }
+
+    /**
+     * Computes the sets of this ZDD that are not in another.
+     * @param o the other ZDD on the same variables.
+     * @return the difference.
+     */
+    DdStructure zddDifference(DdStructure const& o) const {
+        return zddApply_(ZddApply::DIFFERENCE, o);
+    }
+
+    /**
+     * Computes the unions of a set of this ZDD and a set of another.
+     * @param o the other ZDD on the same variables.
+     * @return the join.
+     */
+    DdStructure zddJoin(DdStructure const& o) const {
+        return zddApply_(ZddApply::JOIN, o);
+    }
+
+    /**
+     * Computes the intersections of a set of this ZDD and a set of another.
+     * @param o the other ZDD on the same variables.
+     * @return the meet.
+     */
+    DdStructure zddMeet(DdStructure const& o) const {
+        return zddApply_(ZddApply::MEET, o);
+    }
+
+    /**
+     * Selects the sets of this ZDD that include a set of another.
+     * @param o the other ZDD on the same variables.
+     * @return the selected sets.
+     */
+    DdStructure zddRestrict(DdStructure const& o) const {
+        return zddApply_(ZddApply::RESTRICT, o);
+    }
+
+    /**
+     * Selects the sets of this ZDD that are included in a set of another.
+     * @param o the other ZDD on the same variables.
+     * @return the selected sets.
+     */
+    DdStructure zddPermit(DdStructure const& o) const {
+        return zddApply_(ZddApply::PERMIT, o);
+    }
+
+    /**
+     * Selects the sets of this ZDD that have a variable.
+     * @param level the level of the variable.
+     * @return the selected sets.
+     */
+    DdStructure zddOnset(int level) const {
+        return zddApply_(ZddApply::ONSET, level);
+    }
+
+    /**
+     * Selects the sets of this ZDD that do not have a variable.
+     * @param level the level of the variable.
+     * @return the selected sets.
+     */
+    DdStructure zddOffset(int level) const {
+        return zddApply_(ZddApply::OFFSET, level);
+    }
+
+private:
+    DdStructure zddApply_(ZddApply::Operation op, DdStructure const& o) const {
+        ZddApply za(useMP);
+        NodeId f = za.import(*diagram, root_);
+        NodeId g = za.import(*o.diagram, o.root_);
+        NodeId r = za.apply(op, f, g);
+        NodeTableHandler<ARITY> table;
+        r = za.exportTo(table.privateEntity(), r);
+        return DdStructure(table, r, useMP);
+    }
+
+    DdStructure zddApply_(ZddApply::Operation op, int level) const {
+        ZddApply za(useMP);
+        NodeId f = za.import(*diagram, root_);
+        NodeId r = (op == ZddApply::ONSET) ? za.onset(f, level) :
+                za.offset(f, level);
+        NodeTableHandler<ARITY> table;
+        r = za.exportTo(table.privateEntity(), r);
+        return DdStructure(table, r, useMP);
+    }
+
+public:
+
     /**
      * Counts the number of minterms of the function represented by this BDD.
      * @param numVars the number of input variables of the function.
@@ -443,9 +680,22 @@ public:
      * @return the number of itemsets.
      */
     std::string zddCardinality() const {
+        if (cacheCounts || countTable.isBuiltFor(*diagram, root_)) {
+            return counts().get(root_);
+        }
         return evaluate(ZddCardinality<std::string,ARITY>());
     }
 
+    /**
+     * Counts the number of sets of each size in the family of sets
+     * represented by this ZDD.
+     * @param maxSize the maximum size to be counted if not negative.
+     * @return the numbers of itemsets indexed by their sizes.
+     */
+    std::vector<std::string> zddSizeDistribution(int maxSize = -1) const {
+        return evaluate(ZddSizeDistribution<std::string,ARITY>(maxSize));
+    }
+
     /**
      * Evaluates the DD from the bottom to the top.
      * @param evaluator the driver class that implements DdEval interface.
@@ -582,6 +832,38 @@ public:
             if (begin) next(dd.root_);
         }
 
+        /**
+         * Constructs an iterator positioned at a given itemset,
+         * which serves as a cursor to resume the iteration.
+         * The iterator is end() if the itemset is not a member.
+         * @param dd the DD.
+         * @param itemset the itemset.
+         */
+        const_iterator(DdStructure const& dd, std::set<int> const& itemset) :
+                dd(dd), cursor(-1), path(), itemset(itemset) {
+            std::set<int>::const_reverse_iterator t = itemset.rbegin();
+            NodeId f = dd.root_;
+
+            while (f > 1) {
+                if (t != itemset.rend() && *t == f.row()) {
+                    path.push_back(Selection(f, true));
+                    f = dd.child(f, 1);
+                    ++t;
+                }
+                else {
+                    cursor = path.size();
+                    path.push_back(Selection(f, false));
+                    f = dd.child(f, 0);
+                }
+            }
+
+            if (f != 1 || t != itemset.rend()) { /* end() state */
+                cursor = -2;
+                path.clear();
+                this->itemset.clear();
+            }
+        }
+
         const_iterator& operator++() {
             next(NodeId(0, 0));
             return *this;
@@ -596,7 +878,7 @@ public:
         }
 
         bool operator==(const_iterator const& o) const {
-            return cursor == o.cursor && path == o.path;
+            return (cursor == -2) == (o.cursor == -2) && path == o.path;
         }
 
         bool operator!=(const_iterator const& o) const {
@@ -671,6 +953,166 @@ public:
         return const_iterator(*this, false);
     }
 
+    /**
+     * Returns an iterator to a given instance.
+     * The itemset of an iterator can be saved as its position
+     * and the iteration can be resumed from there by this function.
+     * Supports binary ZDDs only.
+     * @param itemset the instance.
+     * @return iterator to the instance, or end() if it is not found.
+     */
+    const_iterator find(std::set<int> const& itemset) const {
+        return const_iterator(*this, itemset);
+    }
+
+    /**
+     * Returns an iterator to the instance at a given position.
+     * Supports binary ZDDs only.
+     * @param k the rank of the instance starting from "0".
+     * @return iterator to the instance.
+     */
+    const_iterator at(std::string const& k) const {
+        return const_iterator(*this, unrank(k));
+    }
+
+    /**
+     * Gets the position of an itemset in the order of iteration.
+     * Path counts are computed at the first call and kept in the cache
+     * until the diagram is changed or dropCountCache() is called.
+     * Supports binary ZDDs only.
+     * @param itemset the itemset.
+     * @return the rank of the itemset, which starts from "0".
+     */
+    std::string rank(std::set<int> const& itemset) const {
+        CountTable<ARITY> const& ct = counts();
+        MyVector<uint64_t> buf(ct.numWords());
+        BigNumber r(buf.data());
+        r.store(0);
+
+        std::set<int>::const_reverse_iterator t = itemset.rbegin();
+        NodeId f = root_;
+
+        while (f > 1) {
+            if (t != itemset.rend() && *t > f.row()) break;
+
+            if (t != itemset.rend() && *t == f.row()) {
+                r.add(ct.get(child(f, 0)));
+                f = child(f, 1);
+                ++t;
+            }
+            else {
+                f = child(f, 0);
+            }
+        }
+
+        if (f != 1 || t != itemset.rend()) throw std::runtime_error(
+                "The itemset is not a member of the family");
+        return r;
+    }
+
+    /**
+     * Gets the itemset at a given position in the order of iteration.
+     * Supports binary ZDDs only.
+     * @param k the rank starting from "0".
+     * @return the itemset.
+     */
+    std::set<int> unrank(std::string const& k) const {
+        return unrank(std::vector<std::string>(1, k)).front();
+    }
+
+    /**
+     * Gets the itemsets at given positions in the order of iteration.
+     * The diagram is traversed only once for all the positions.
+     * Supports binary ZDDs only.
+     * @param ks the ranks in non-decreasing order.
+     * @return the itemsets in the same order as @p ks.
+     */
+    std::vector<std::set<int> > unrank(std::vector<std::string> const& ks) const {
+        CountTable<ARITY> const& ct = counts();
+        int const w = ct.numWords();
+        size_t const m = ks.size();
+        MyVector<uint64_t> buf(m * w);
+        MyVector<BigNumber> keys(m);
+
+        for (size_t j = 0; j < m; ++j) {
+            MyVector<uint64_t> tmpBuf(ks[j].size() * 10 / 189 + 2);
+            BigNumber tmp(tmpBuf.data());
+            tmp.store(0);
+
+            for (size_t l = 0; l < ks[j].size(); ++l) {
+                char c = ks[j][l];
+                if (c < '0' || '9' < c) throw std::runtime_error(
+                        "Invalid rank: " + ks[j]);
+                tmp.multiplyAdd(10, c - '0');
+            }
+
+            if (ks[j].empty() || tmp.compare(ct.get(root_)) >= 0) {
+                throw std::runtime_error("Rank out of range: " + ks[j]);
+            }
+            if (j > 0 && tmp.compare(keys[j - 1]) < 0) {
+                throw std::runtime_error("Ranks are not sorted: " + ks[j]);
+            }
+
+            keys[j].setArray(buf.data() + j * w);
+            keys[j].store(tmp);
+        }
+
+        std::vector<std::set<int> > result(m);
+        MyVector<uint64_t> work((root_.row() + 2) * w);
+        BigNumber base(work.data());
+        base.store(0);
+        std::vector<int> items;
+        unrank_(ct, root_, base, keys, 0, m, work, items, result);
+        return result;
+    }
+
+private:
+    CountTable<ARITY> const& counts() const {
+        if (!countTable.isBuiltFor(*diagram, root_)) {
+            countTable.build(*diagram, root_, useMP);
+        }
+        return countTable;
+    }
+
+    void unrank_(CountTable<ARITY> const& ct, NodeId f, BigNumber const& base,
+            MyVector<BigNumber> const& keys, size_t lo, size_t hi,
+            MyVector<uint64_t>& work, std::vector<int>& items,
+            std::vector<std::set<int> >& result) const {
+        if (lo == hi) return;
+        assert(f != 0);
+
+        if (f == 1) {
+            std::set<int> const itemset(items.begin(), items.end());
+            for (size_t j = lo; j < hi; ++j) {
+                result[j] = itemset;
+            }
+            return;
+        }
+
+        NodeId f0 = child(f, 0);
+        BigNumber threshold(work.data() + (f.row() + 1) * ct.numWords());
+        threshold.store(base);
+        threshold.add(ct.get(f0));
+
+        size_t l = lo;
+        size_t h = hi;
+        while (l < h) {
+            size_t mid = (l + h) / 2;
+            if (keys[mid].compare(threshold) < 0) {
+                l = mid + 1;
+            }
+            else {
+                h = mid;
+            }
+        }
+
+        unrank_(ct, f0, base, keys, lo, l, work, items, result);
+        items.push_back(f.row());
+        unrank_(ct, child(f, 1), threshold, keys, l, hi, work, items, result);
+        items.pop_back();
+    }
+
+public:
     /**
      * Implements DdSpec.
      */
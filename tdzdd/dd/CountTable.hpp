@@ -0,0 +1,194 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <stdint.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "DataTable.hpp"
+#include "Node.hpp"
+#include "NodeTable.hpp"
+#include "../util/BigNumber.hpp"
+#include "../util/MemoryPool.hpp"
+#include "../util/MyVector.hpp"
+
+namespace tdzdd {
+
+/**
+ * Table of the numbers of paths to the 1-terminal from every node.
+ * The numbers are kept in memory pools until the table is cleared.
+ * A copy of the table is always empty.
+ * @tparam ARITY arity of the nodes.
+ */
+template<int ARITY>
+class CountTable {
+    NodeTableEntity<ARITY> const* diagram; ///< The diagram counted.
+    NodeId root;                             ///< The root node counted.
+    int numWords_;                           ///< Words enough for any count.
+    size_t words;                            ///< Words allocated in pools.
+    DataTable<BigNumber> table;
+    MyVector<MemoryPool> pools;
+
+public:
+    CountTable() :
+            diagram(0), root(0), numWords_(1), words(0) {
+    }
+
+    CountTable(CountTable const& o) :
+            diagram(0), root(0), numWords_(1), words(0) {
+    }
+
+    CountTable& operator=(CountTable const& o) {
+        clear();
+        return *this;
+    }
+
+    /**
+     * Builds the table.
+     * @param diagram the node table.
+     * @param root the root node.
+     * @param useMP use algorithms for multiple processors.
+     */
+    void build(NodeTableEntity<ARITY> const& diagram, NodeId root,
+            bool useMP = false) {
+        clear();
+        int const n = root.row();
+        numWords_ = ceil(double(n) * log2(double(ARITY)) / 63.0) + 1;
+        table.init(n + 1);
+#ifdef _OPENMP
+        int const threads = useMP ? omp_get_max_threads() : 1;
+#else
+        int const threads = 1;
+#endif
+        pools.resize(threads);
+
+        table[0].resize(2);
+        for (int j = 0; j < 2; ++j) {
+            table[0][j].setArray(pools[0].template allocate<uint64_t>(1));
+            table[0][j].store(j);
+        }
+        words = 2;
+
+        for (int i = 1; i <= n; ++i) {
+            MyVector<Node<ARITY> > const& node = diagram[i];
+            intmax_t const m = node.size();
+            table[i].resize(m);
+
+#ifdef _OPENMP
+#pragma omp parallel if (threads > 1)
+#endif
+            {
+#ifdef _OPENMP
+                int const k = omp_get_thread_num();
+#else
+                int const k = 0;
+#endif
+                MemoryPool& pool = pools[k];
+                MyVector<uint64_t> buf(numWords_);
+                BigNumber tmp(buf.data());
+                size_t w = 0;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+                for (intmax_t j = 0; j < m; ++j) {
+                    size_t ww = tmp.store(0);
+                    for (int b = 0; b < ARITY; ++b) {
+                        NodeId f = node[j].branch[b];
+                        ww = tmp.add(table[f.row()][f.col()]);
+                    }
+                    table[i][j].setArray(pool.template allocate<uint64_t>(ww));
+                    table[i][j].store(tmp);
+                    w += ww;
+                }
+
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+                words += w;
+            }
+        }
+
+        this->diagram = &diagram;
+        this->root = root;
+    }
+
+    /**
+     * Releases all the memory.
+     */
+    void clear() {
+        table.init();
+        pools.clear();
+        diagram = 0;
+        root = 0;
+        numWords_ = 1;
+        words = 0;
+    }
+
+    /**
+     * Checks if the table has been built for a given diagram.
+     * @param diagram the node table.
+     * @param root the root node.
+     * @return true if the table is available.
+     */
+    bool isBuiltFor(NodeTableEntity<ARITY> const& diagram, NodeId root) const {
+        return this->diagram == &diagram && this->root == root;
+    }
+
+    /**
+     * Gets the number of paths from a node to the 1-terminal.
+     * @param f node ID.
+     * @return the number of paths.
+     */
+    BigNumber const& get(NodeId f) const {
+        assert(f.row() < table.numRows());
+        assert(f.col() < table[f.row()].size());
+        return table[f.row()][f.col()];
+    }
+
+    /**
+     * Gets the number of words enough to store any number in the table.
+     * @return the number of words.
+     */
+    int numWords() const {
+        return numWords_;
+    }
+
+    /**
+     * Estimates the memory usage.
+     * @return the number of bytes used by the table.
+     */
+    size_t memoryUsage() const {
+        return words * sizeof(uint64_t) + table.totalSize() * sizeof(BigNumber);
+    }
+};
+
+} // namespace tdzdd
@@ -24,10 +24,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
 #include <ostream>
+#include <sstream>
 #include <stdexcept>
+#include <string>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -37,11 +41,14 @@
 #include "Node.hpp"
 #include "NodeTable.hpp"
 #include "../DdSpec.hpp"
+#include "../util/MemoryBudget.hpp"
 #include "../util/MemoryPool.hpp"
 #include "../util/MessageHandler.hpp"
 #include "../util/MyHashTable.hpp"
 #include "../util/MyList.hpp"
 #include "../util/MyVector.hpp"
+#include "../util/RunStatistics.hpp"
+#include "../util/WorkStealingScheduler.hpp"
 
 namespace tdzdd {
 
@@ -188,10 +195,100 @@ class DdBuilder: DdBuilderBase {
     void* const one;
     MyVector<NodeBranchId> oneSrcPtr;
 
+    struct SpillSegment {
+        long offset;
+        size_t count;
+    };
+
+    MemoryBudget const* budget;
+    size_t baseBytes;
+    size_t builtNodes;
+    size_t pendingStates;
+    int lowestPending;
+    std::FILE* spillFile;
+    MyVector<MyVector<SpillSegment> > spillTable;
+
     void init(int n) {
         snodeTable.resize(n + 1);
         if (n >= output.numRows()) output.setNumRows(n + 1);
         oneSrcPtr.clear();
+        lowestPending = n;
+    }
+
+    size_t memoryUsage() const {
+        return baseBytes + (builtNodes - sweeper.sweptNodes()) * sizeof(Node<AR>)
+                + pendingStates * specNodeSize * sizeof(SpecNode);
+    }
+
+    /**
+     * Writes the pending states of the levels below i - 1 to the spill file.
+     * @param i current level.
+     */
+    void spill(int i) {
+        for (int j = std::max(lowestPending, 1); j < i - 1; ++j) {
+            MyList<SpecNode>& snodes = snodeTable[j];
+            if (snodes.empty()) continue;
+
+            if (spillFile == 0) {
+                spillFile = std::tmpfile();
+                if (spillFile == 0) throw std::runtime_error(
+                        "ERROR: Cannot create a spill file");
+                spillTable.resize(snodeTable.size());
+            }
+            std::fseek(spillFile, 0, SEEK_END);
+            SpillSegment seg;
+            seg.offset = std::ftell(spillFile);
+            seg.count = snodes.size();
+
+            for (MyList<SpecNode>::iterator t = snodes.begin();
+                    t != snodes.end(); ++t) {
+                if (std::fwrite(*t, sizeof(SpecNode), specNodeSize, spillFile)
+                        != size_t(specNodeSize)) throw std::runtime_error(
+                        "ERROR: Cannot write the spill file");
+            }
+
+            snodes.clear();
+            spillTable[j].push_back(seg);
+            pendingStates -= seg.count;
+        }
+    }
+
+    /**
+     * Reads the spilled states of level i back.
+     * @param i level.
+     */
+    void unspill(int i) {
+        if (size_t(i) >= spillTable.size()) return;
+        MyVector<SpillSegment>& segs = spillTable[i];
+
+        for (size_t k = 0; k < segs.size(); ++k) {
+            std::fseek(spillFile, segs[k].offset, SEEK_SET);
+            for (size_t c = 0; c < segs[k].count; ++c) {
+                SpecNode* p = snodeTable[i].alloc_front(specNodeSize);
+                if (std::fread(p, sizeof(SpecNode), specNodeSize, spillFile)
+                        != size_t(specNodeSize)) throw std::runtime_error(
+                        "ERROR: Cannot read the spill file");
+            }
+            pendingStates += segs[k].count;
+        }
+        segs.clear();
+    }
+
+    std::string levelWidths(int i) const {
+        std::ostringstream oss;
+        oss << "level\tnodes\tpending\n";
+        for (int j = snodeTable.size() - 1; j >= 1; --j) {
+            size_t nodes = (j >= i) ? output[j].size() : 0;
+            size_t pending = snodeTable[j].size();
+            if (size_t(j) < spillTable.size()) {
+                for (size_t k = 0; k < spillTable[j].size(); ++k) {
+                    pending += spillTable[j][k].count;
+                }
+            }
+            if (nodes == 0 && pending == 0) continue;
+            oss << j << "\t" << nodes << "\t" << pending << "\n";
+        }
+        return oss.str();
     }
 
 public:
@@ -201,7 +298,13 @@ public:
             output(output.privateEntity()),
             sweeper(this->output, oneSrcPtr),
             oneStorage(spec.datasize()),
-            one(oneStorage.data()) {
+            one(oneStorage.data()),
+            budget(0),
+            baseBytes(0),
+            builtNodes(0),
+            pendingStates(0),
+            lowestPending(0),
+            spillFile(0) {
         if (n >= 1) init(n);
     }
 
@@ -210,6 +313,41 @@ public:
             spec.destruct(one);
             oneSrcPtr.clear();
         }
+        if (spillFile) std::fclose(spillFile);
+    }
+
+    /**
+     * Sets a memory budget, which is checked by checkMemory(int).
+     * The memory already in use is taken as the base of the estimate.
+     * @param b the budget, which must outlive the builder.
+     */
+    void setMemoryBudget(MemoryBudget const& b) {
+        budget = &b;
+        baseBytes = MemoryBudget::residentBytes();
+    }
+
+    /**
+     * Escalates the strategies of the memory budget after a level is built.
+     * @param i the level just built.
+     * @throws MemoryBudgetExceeded if the estimated usage reaches the limit.
+     */
+    void checkMemory(int i) {
+        if (budget == 0 || budget->limit() == 0) return;
+        if (memoryUsage() < budget->sweepThreshold()) return;
+
+        sweeper.setEager();
+        if (budget->spill() && memoryUsage() >= budget->spillThreshold()) {
+            spill(i);
+        }
+
+        size_t const usage = memoryUsage();
+        if (usage >= budget->limit()) {
+            std::ostringstream oss;
+            oss << "ERROR: Memory budget of " << budget->limit() / 1048576
+                << "MB exceeded at level " << i << " (estimated "
+                << usage / 1048576 << "MB)";
+            throw MemoryBudgetExceeded(oss.str(), levelWidths(i));
+        }
     }
 
     /**
@@ -222,6 +360,24 @@ public:
         SpecNode* p0 = snodeTable[level].alloc_front(specNodeSize);
         spec.get_copy(state(p0), s);
         srcPtr(p0) = fp;
+        ++pendingStates;
+    }
+
+    /**
+     * Makes the sweeper apply the ZDD reduction rules to the levels
+     * whose edges are completed while the construction.
+     * reduce() must be called after the last level is built.
+     * @param flag true to reduce the ZDD on the fly.
+     */
+    void setZddReduction(bool flag = true) {
+        sweeper.setReduction(flag);
+    }
+
+    /**
+     * Finishes the ZDD reduction in place after the last level is built.
+     */
+    void reduce() {
+        sweeper.reduce();
     }
 
     /**
@@ -258,15 +414,22 @@ public:
     void construct(int i) {
         assert(0 < i && size_t(i) < snodeTable.size());
 
+        if (spillFile) unspill(i);
         MyList<SpecNode> &snodes = snodeTable[i];
+        pendingStates -= snodes.size();
         size_t j0 = output[i].size();
         size_t m = j0;
         int lowestChild = i - 1;
         size_t deadCount = 0;
+        size_t zeroCount = 0;
+        bool const stats = RunStatistics::enabled();
+        double const startTime = stats ? getWallClockTime() : 0;
+        RunStatistics::Level rec("build", i);
 
         {
             Hasher<Spec> hasher(spec, i);
             UniqTable uniq(snodes.size() * 2, hasher, hasher);
+            if (stats) rec.generated = snodes.size();
 
             for (MyList<SpecNode>::iterator t = snodes.begin();
                     t != snodes.end(); ++t) {
@@ -298,6 +461,11 @@ public:
 //            MessageHandler mh;
 //            mh << "table_size[" << i << "] = " << uniq.tableSize() << "\n";
 //#endif
+            if (stats) {
+                rec.unique = uniq.size();
+                rec.tableSize = uniq.tableSize();
+                rec.collisions = uniq.collisions();
+            }
         }
 
         output[i].resize(m);
@@ -315,6 +483,7 @@ public:
             }
 
             bool allZero = true;
+            bool zeroHigh = true;
 
             for (int b = 0; b < AR; ++b) {
                 if (nodeId(p) == 0) {
@@ -360,11 +529,14 @@ public:
                     }
                     spec.destruct(state(pp));
                     allZero = false;
+                    if (b > 0 && q.branch[b] != 0) zeroHigh = false;
                 }
                 else if (ii == i - 1) {
                     srcPtr(pp) = &q.branch[b];
                     pp = snodeTable[ii].alloc_front(specNodeSize);
+                    ++pendingStates;
                     allZero = false;
+                    if (b > 0) zeroHigh = false;
                 }
                 else {
                     assert(ii < i - 1);
@@ -372,19 +544,32 @@ public:
                     spec.get_copy(state(ppp), state(pp));
                     spec.destruct(state(pp));
                     srcPtr(ppp) = &q.branch[b];
+                    ++pendingStates;
                     if (ii < lowestChild) lowestChild = ii;
                     allZero = false;
+                    if (b > 0) zeroHigh = false;
                 }
             }
 
             spec.destruct(state(p));
             ++jj;
             if (allZero) ++deadCount;
+            if (zeroHigh) ++zeroCount;
         }
 
         snodeTable[i - 1].pop_front();
         spec.destructLevel(i);
-        sweeper.update(i, lowestChild, deadCount);
+        builtNodes += m - j0;
+        if (lowestChild < lowestPending) lowestPending = lowestChild;
+        sweeper.update(i, lowestChild,
+                       sweeper.reducing() ? zeroCount : deadCount);
+
+        if (stats) {
+            rec.nodes = m - j0;
+            rec.merged = rec.generated - rec.nodes;
+            rec.dead = deadCount;
+            RunStatistics::record(rec, startTime);
+        }
     }
 };
 
@@ -436,6 +621,7 @@ public:
             output(output.privateEntity()),
             sweeper(this->output),
             snodeTables(threads) {
+        sweeper.useMultiProcessors();
         if (n >= 1) init(n);
 #ifdef DEBUG
         MessageHandler mh;
@@ -464,6 +650,23 @@ public:
         srcPtr(p0) = fp;
     }
 
+    /**
+     * Makes the sweeper apply the ZDD reduction rules to the levels
+     * whose edges are completed while the construction.
+     * reduce() must be called after the last level is built.
+     * @param flag true to reduce the ZDD on the fly.
+     */
+    void setZddReduction(bool flag = true) {
+        sweeper.setReduction(flag);
+    }
+
+    /**
+     * Finishes the ZDD reduction in place after the last level is built.
+     */
+    void reduce() {
+        sweeper.reduce();
+    }
+
     /**
      * Initializes the builder.
      * @param root result storage.
@@ -498,6 +701,14 @@ public:
         MyVector<size_t> nodeColumn(tasks);
         int lowestChild = i - 1;
         size_t deadCount = 0;
+        size_t zeroCount = 0;
+        bool const stats = RunStatistics::enabled();
+        double const startTime = stats ? getWallClockTime() : 0;
+        size_t const j0 = output[i].size();
+        size_t generated = 0;
+        size_t unique = 0;
+        size_t tableSize = 0;
+        size_t collisions = 0;
 
 #ifdef DEBUG
         etcP1.start();
@@ -505,7 +716,7 @@ public:
 
 #ifdef _OPENMP
         // OpenMP 2.0 does not support reduction(min:lowestChild)
-#pragma omp parallel reduction(+:deadCount)
+#pragma omp parallel reduction(+:deadCount,zeroCount,generated,unique,tableSize,collisions)
 #endif
         {
 #ifdef _OPENMP
@@ -565,6 +776,12 @@ public:
                 }
 
                 nodeColumn[x] = j;
+                if (stats) {
+                    generated += m;
+                    unique += uniq.size();
+                    tableSize += uniq.tableSize();
+                    collisions += uniq.collisions();
+                }
 //#ifdef DEBUG
 //                MessageHandler mh;
 //#ifdef _OPENMP
@@ -620,6 +837,7 @@ public:
 
                         Node<AR> &q = output[i][j];
                         bool allZero = true;
+                        bool zeroHigh = true;
                         void* s = tmpState;
 
                         for (int b = 0; b < AR; ++b) {
@@ -635,6 +853,7 @@ public:
                             if (ii <= 0) {
                                 q.branch[b] = ii ? 1 : 0;
                                 if (ii) allZero = false;
+                                if (ii && b > 0) zeroHigh = false;
                             }
                             else {
                                 assert(ii <= i - 1);
@@ -646,12 +865,14 @@ public:
                                 srcPtr(pp) = &q.branch[b];
                                 if (ii < lc) lc = ii;
                                 allZero = false;
+                                if (b > 0) zeroHigh = false;
                             }
 
                             spec.destruct(s);
                         }
 
                         if (allZero) ++deadCount;
+                        if (zeroHigh) ++zeroCount;
                     }
                 }
             }
@@ -664,10 +885,23 @@ public:
             if (lc < lowestChild) lowestChild = lc;
         }
 
-        sweeper.update(i, lowestChild, deadCount);
+        sweeper.update(i, lowestChild,
+                       sweeper.reducing() ? zeroCount : deadCount);
 #ifdef DEBUG
         etcP2.stop();
 #endif
+
+        if (stats) {
+            RunStatistics::Level rec("build_mp", i);
+            rec.generated = generated;
+            rec.unique = unique;
+            rec.nodes = output[i].size() - j0;
+            rec.merged = generated - rec.nodes;
+            rec.dead = deadCount;
+            rec.tableSize = tableSize;
+            rec.collisions = collisions;
+            RunStatistics::record(rec, startTime);
+        }
     }
 };
 
@@ -953,9 +1187,12 @@ private:
 
 /**
  * Multi-threaded breadth-first ZDD subset builder.
+ * The columns of each level are distributed by a work-stealing scheduler.
+ * Each thread merges the states that reach the 1-terminal in the level
+ * on its own, and they are merged across the threads after the level.
  */
 template<typename S>
-class ZddSubsetterMP: DdBuilderMPBase { //TODO oneStorage
+class ZddSubsetterMP: DdBuilderMPBase {
 //typedef typename std::remove_const<typename std::remove_reference<S>::type>::type Spec;
     typedef S Spec;
     typedef MyHashTable<SpecNode*,Hasher<Spec>,Hasher<Spec> > UniqTable;
@@ -968,10 +1205,17 @@ class ZddSubsetterMP: DdBuilderMPBase { //TODO oneStorage
     NodeTableEntity<AR> const& input;
     NodeTableEntity<AR>& output;
     DdSweeper<AR> sweeper;
+    WorkStealingScheduler scheduler;
 
     MyVector<MyVector<MyVector<MyListOnPool<SpecNode> > > > snodeTables;
     MyVector<MemoryPools> pools;
 
+    MyVector<char> oneStorage;
+    void* const one;
+    MyVector<NodeBranchId> oneSrcPtr;
+    MyVector<MyVector<char> > oneStorages; ///< for each thread.
+    MyVector<MyVector<NodeBranchId> > oneSrcPtrs; ///< for each thread.
+
 public:
     ZddSubsetterMP(NodeTableHandler<AR> const& input,
                    Spec const& s,
@@ -986,9 +1230,22 @@ public:
             specNodeSize(getSpecNodeSize(s.datasize())),
             input(*input),
             output(output.privateEntity()),
-            sweeper(this->output),
+            sweeper(this->output, oneSrcPtr),
+            scheduler(threads),
             snodeTables(threads),
-            pools(threads) {
+            pools(threads),
+            oneStorage(s.datasize()),
+            one(oneStorage.data()),
+            oneStorages(threads, MyVector<char>(s.datasize())),
+            oneSrcPtrs(threads) {
+        sweeper.useMultiProcessors();
+    }
+
+    ~ZddSubsetterMP() {
+        if (!oneSrcPtr.empty()) {
+            specs[0].destruct(one);
+            oneSrcPtr.clear();
+        }
     }
 
     /**
@@ -1038,6 +1295,10 @@ public:
 
         spec.destruct(tmpState);
         output.init(n + 1);
+        if (!oneSrcPtr.empty()) {
+            spec.destruct(one);
+            oneSrcPtr.clear();
+        }
         return n;
     }
 
@@ -1052,6 +1313,7 @@ public:
         MyVector<size_t> nodeColumn(m);
         int lowestChild = i - 1;
         size_t deadCount = 0;
+        scheduler.reset(m);
 
 #ifdef _OPENMP
         // OpenMP 2.0 does not support reduction(min:lowestChild)
@@ -1069,47 +1331,48 @@ public:
             Hasher<Spec> hasher(spec, i);
             UniqTable uniq(hasher, hasher);
             int lc = lowestChild;
+            size_t jBegin, jEnd;
+
+            while (scheduler.next(yy, jBegin, jEnd)) {
+                for (size_t j = jBegin; j < jEnd; ++j) {
+                    size_t mm = 0;
+                    for (int y = 0; y < threads; ++y) {
+                        if (snodeTables[y][i].empty()) continue;
+                        MyListOnPool<SpecNode> &snodes = snodeTables[y][i][j];
+                        mm += snodes.size();
+                    }
+                    uniq.initialize(mm * 2);
+                    size_t jj = 0;
 
-#ifdef _OPENMP
-#pragma omp for schedule(dynamic)
-#endif
-            for (intmax_t j = 0; j < intmax_t(m); ++j) {
-                size_t mm = 0;
-                for (int y = 0; y < threads; ++y) {
-                    if (snodeTables[y][i].empty()) continue;
-                    MyListOnPool<SpecNode> &snodes = snodeTables[y][i][j];
-                    mm += snodes.size();
-                }
-                uniq.initialize(mm * 2);
-                size_t jj = 0;
-
-                for (int y = 0; y < threads; ++y) {
-                    if (snodeTables[y][i].empty()) continue;
-                    MyListOnPool<SpecNode> &snodes = snodeTables[y][i][j];
+                    for (int y = 0; y < threads; ++y) {
+                        if (snodeTables[y][i].empty()) continue;
+                        MyListOnPool<SpecNode> &snodes = snodeTables[y][i][j];
 
-                    for (MyListOnPool<SpecNode>::iterator t = snodes.begin();
-                            t != snodes.end(); ++t) {
-                        SpecNode* p = *t;
-                        SpecNode* pp = uniq.add(p);
+                        for (MyListOnPool<SpecNode>::iterator t =
+                                snodes.begin(); t != snodes.end(); ++t) {
+                            SpecNode* p = *t;
+                            SpecNode* pp = uniq.add(p);
 
-                        if (pp == p) {
-                            code(p) = ++jj; // code(p) >= 1
-                        }
-                        else {
-                            code(p) = -code(pp);
-                            if (int prune = spec.merge_states(state(pp),
-                                    state(p))) {
-                                if (prune & 1) code(pp) = 0;
-                                if (prune & 2) code(p) = 0;
+                            if (pp == p) {
+                                code(p) = ++jj; // code(p) >= 1
+                            }
+                            else {
+                                code(p) = -code(pp);
+                                if (int prune = spec.merge_states(state(pp),
+                                        state(p))) {
+                                    if (prune & 1) code(pp) = 0;
+                                    if (prune & 2) code(p) = 0;
+                                }
                             }
                         }
                     }
-                }
 
-                nodeColumn[j] = jj;
+                    nodeColumn[j] = jj;
+                }
             }
 
 #ifdef _OPENMP
+#pragma omp barrier
 #pragma omp single
 #endif
             {
@@ -1121,89 +1384,98 @@ public:
                 }
 
                 output.initRow(i, mm);
+                scheduler.reset(m);
             }
 
-#ifdef _OPENMP
-#pragma omp for schedule(dynamic)
-#endif
-            for (intmax_t j = 0; j < intmax_t(m); ++j) {
-                size_t const jj0 = nodeColumn[j] - 1;   // code(p) >= 1
+            while (scheduler.next(yy, jBegin, jEnd)) {
+                for (size_t j = jBegin; j < jEnd; ++j) {
+                    size_t const jj0 = nodeColumn[j] - 1; // code(p) >= 1
 
-                for (int y = 0; y < threads; ++y) {
-                    if (snodeTables[y][i].empty()) continue;
+                    for (int y = 0; y < threads; ++y) {
+                        if (snodeTables[y][i].empty()) continue;
 
-                    MyListOnPool<SpecNode> &snodes = snodeTables[y][i][j];
+                        MyListOnPool<SpecNode> &snodes = snodeTables[y][i][j];
 
-                    for (MyListOnPool<SpecNode>::iterator t = snodes.begin();
-                            t != snodes.end(); ++t) {
-                        SpecNode* p = *t;
+                        for (MyListOnPool<SpecNode>::iterator t =
+                                snodes.begin(); t != snodes.end(); ++t) {
+                            SpecNode* p = *t;
 
-                        if (code(p) <= 0) {
-                            *srcPtr(p) = code(p) ? NodeId(i, jj0 - code(p)) : 0;
-                            spec.destruct(state(p));
-                            continue;
-                        }
-
-                        size_t const jj = jj0 + code(p);
-                        *srcPtr(p) = NodeId(i, jj);
-                        Node<AR> &q = output[i][jj];
-                        bool allZero = true;
-                        void* s = tmpState;
-
-                        for (int b = 0; b < AR; ++b) {
-                            if (b < AR - 1) {
-                                spec.get_copy(s, state(p));
-                            }
-                            else {
-                                s = state(p);
+                            if (code(p) <= 0) {
+                                *srcPtr(p) =
+                                        code(p) ? NodeId(i, jj0 - code(p)) : 0;
+                                spec.destruct(state(p));
+                                continue;
                             }
 
-                            NodeId f(i, j);
-                            int kk = downTable(f, b, i - 1);
-                            int ii = downSpec(spec, s, i, b, kk);
+                            size_t const jj = jj0 + code(p);
+                            *srcPtr(p) = NodeId(i, jj);
+                            Node<AR> &q = output[i][jj];
+                            bool allZero = true;
+                            void* s = tmpState;
 
-                            while (ii != 0 && kk != 0 && ii != kk) {
-                                if (ii < kk) {
-                                    assert(kk >= 1);
-                                    kk = downTable(f, 0, ii);
+                            for (int b = 0; b < AR; ++b) {
+                                if (b < AR - 1) {
+                                    spec.get_copy(s, state(p));
                                 }
                                 else {
-                                    assert(ii >= 1);
-                                    ii = downSpec(spec, s, ii, 0, kk);
+                                    s = state(p);
                                 }
-                            }
 
-                            if (ii <= 0 || kk <= 0) {
-                                bool val = ii != 0 && kk != 0;
-                                q.branch[b] = val;
-                                if (val) allZero = false;
-                            }
-                            else {
-                                assert(ii == f.row() && ii == kk && ii < i);
-                                size_t jj = f.col();
+                                NodeId f(i, j);
+                                int kk = downTable(f, b, i - 1);
+                                int ii = downSpec(spec, s, i, b, kk);
 
-                                if (snodeTables[yy][ii].empty()) {
-                                    snodeTables[yy][ii].resize(
-                                            input[ii].size());
+                                while (ii != 0 && kk != 0 && ii != kk) {
+                                    if (ii < kk) {
+                                        assert(kk >= 1);
+                                        kk = downTable(f, 0, ii);
+                                    }
+                                    else {
+                                        assert(ii >= 1);
+                                        ii = downSpec(spec, s, ii, 0, kk);
+                                    }
                                 }
 
-                                SpecNode* pp =
-                                        snodeTables[yy][ii][jj].alloc_front(
-                                                pools[yy][ii], specNodeSize);
-                                spec.get_copy(state(pp), s);
-                                srcPtr(pp) = &q.branch[b];
-                                if (ii < lc) lc = ii;
-                                allZero = false;
+                                if (ii <= 0 || kk <= 0) {
+                                    if (ii == 0 || kk == 0) {
+                                        q.branch[b] = 0;
+                                    }
+                                    else {
+                                        q.branch[b] = addOne(yy, s,
+                                                NodeBranchId(i, jj, b));
+                                        allZero = false;
+                                    }
+                                }
+                                else {
+                                    assert(ii == f.row() && ii == kk && ii < i);
+                                    size_t jj = f.col();
+
+                                    if (snodeTables[yy][ii].empty()) {
+                                        snodeTables[yy][ii].resize(
+                                                input[ii].size());
+                                    }
+
+                                    SpecNode* pp =
+                                            snodeTables[yy][ii][jj].alloc_front(
+                                                    pools[yy][ii], specNodeSize);
+                                    spec.get_copy(state(pp), s);
+                                    srcPtr(pp) = &q.branch[b];
+                                    if (ii < lc) lc = ii;
+                                    allZero = false;
+                                }
+
+                                spec.destruct(s);
                             }
 
-                            spec.destruct(s);
+                            if (allZero) ++deadCount;
                         }
-
-                        if (allZero) ++deadCount;
                     }
                 }
             }
 
+#ifdef _OPENMP
+#pragma omp barrier
+#endif
             snodeTables[yy][i].clear();
             pools[yy][i].clear();
             spec.destructLevel(i);
@@ -1214,10 +1486,94 @@ public:
             if (lc < lowestChild) lowestChild = lc;
         }
 
+        for (int y = 0; y < threads; ++y) {
+            mergeOnes(y);
+        }
         sweeper.update(i, lowestChild, deadCount);
     }
 
 private:
+    /**
+     * Records a state that reaches the 1-terminal in the current level,
+     * merging it with the other states of the same thread.
+     * @param y the thread number.
+     * @param s the state.
+     * @param nbi the branch that leads to the 1-terminal.
+     * @return the new value of the branch.
+     */
+    NodeId addOne(int y, void* s, NodeBranchId const& nbi) {
+        Spec& spec = specs[y];
+        void* const oneY = oneStorages[y].data();
+        MyVector<NodeBranchId>& srcs = oneSrcPtrs[y];
+
+        if (srcs.empty()) { // the first 1-terminal candidate of the thread
+            spec.get_copy(oneY, s);
+            srcs.push_back(nbi);
+            return 1;
+        }
+
+        switch (spec.merge_states(oneY, s)) {
+        case 1:
+            while (!srcs.empty()) {
+                NodeBranchId const& b = srcs.back();
+                output[b.row][b.col].branch[b.val] = 0;
+                srcs.pop_back();
+            }
+            spec.destruct(oneY);
+            spec.get_copy(oneY, s);
+            srcs.push_back(nbi);
+            return 1;
+        case 2:
+            return 0;
+        default:
+            srcs.push_back(nbi);
+            return 1;
+        }
+    }
+
+    /**
+     * Merges the 1-terminal candidates of a thread into the global one.
+     * @param y the thread number.
+     */
+    void mergeOnes(int y) {
+        void* const oneY = oneStorages[y].data();
+        MyVector<NodeBranchId>& srcs = oneSrcPtrs[y];
+        if (srcs.empty()) return;
+
+        Spec& spec = specs[0];
+        int prune = 0;
+
+        if (oneSrcPtr.empty()) {
+            spec.get_copy(one, oneY);
+        }
+        else {
+            prune = spec.merge_states(one, oneY);
+        }
+
+        if (prune == 1) {
+            while (!oneSrcPtr.empty()) {
+                NodeBranchId const& b = oneSrcPtr.back();
+                output[b.row][b.col].branch[b.val] = 0;
+                oneSrcPtr.pop_back();
+            }
+            spec.destruct(one);
+            spec.get_copy(one, oneY);
+        }
+
+        for (size_t k = 0; k < srcs.size(); ++k) {
+            NodeBranchId const& b = srcs[k];
+            if (prune == 2) {
+                output[b.row][b.col].branch[b.val] = 0;
+            }
+            else {
+                oneSrcPtr.push_back(b);
+            }
+        }
+
+        specs[y].destruct(oneY);
+        srcs.clear();
+    }
+
     int downTable(NodeId& f, int b, int zerosupLevel) const {
         if (zerosupLevel < 0) zerosupLevel = 0;
 
@@ -38,6 +38,7 @@
 #include "../util/MyHashTable.hpp"
 #include "../util/MyList.hpp"
 #include "../util/MyVector.hpp"
+#include "../util/RunStatistics.hpp"
 
 namespace tdzdd {
 
@@ -49,6 +50,7 @@ class DdReducer {
     NodeTableEntity<ARITY>& output;
     MyVector<MyVector<NodeId> > newIdTable;
     MyVector<MyVector<NodeId*> > rootPtr;
+    bool const inPlace;
 
     struct ReducNodeInfo {
         Node<ARITY> children;
@@ -84,13 +86,23 @@ class DdReducer {
     bool readyForSequentialReduction;
 
 public:
-    DdReducer(NodeTableHandler<ARITY>& diagram, bool useMP = false) :
+    /**
+     * Constructor.
+     * In place, the nodes are renumbered and compacted within the rows of
+     * the diagram, without allocating another node table.
+     * @param diagram the diagram to reduce.
+     * @param useMP use algorithms for multiple processors.
+     * @param inPlace reduce the diagram in place.
+     */
+    DdReducer(NodeTableHandler<ARITY>& diagram, bool useMP = false,
+            bool inPlace = false) :
             input(diagram.privateEntity()),
             oldDiagram(diagram),
-            newDiagram(input.numRows()),
-            output(newDiagram.privateEntity()),
+            newDiagram(inPlace ? 1 : input.numRows()),
+            output(inPlace ? input : newDiagram.privateEntity()),
             newIdTable(input.numRows()),
             rootPtr(input.numRows()),
+            inPlace(inPlace),
 #ifdef _OPENMP
             threads(omp_get_max_threads()),
             tasks(MyHashConstant::primeSize(TASKS_PER_THREAD * threads)),
@@ -107,7 +119,7 @@ public:
         etcS0.start();
 #endif
 #endif
-        diagram = newDiagram;
+        if (!inPlace) diagram = newDiagram;
 
         input.initTerminals();
         input.makeIndex(useMP);
@@ -126,9 +138,17 @@ public:
 #endif
     }
 
+    ~DdReducer() {
+        if (inPlace) {
+            // the index of the levels no longer matches the reduced rows
+            input.deleteIndex();
+            // release the spare capacity of the compacted rows
+            for (int i = 1; i < input.numRows(); ++i) {
+                input[i].resize(input[i].size());
+            }
+        }
 #ifdef _OPENMP
 #ifdef DEBUG
-    ~DdReducer() {
         if (etcP1 != 0) {
             MessageHandler mh;
             mh << "P1: " << etcP1 << "\n";
@@ -140,9 +160,9 @@ public:
             mh << "S3: " << etcS3 << "\n";
             mh << "S4: " << etcS4 << "\n";
         }
-    }
 #endif
 #endif
+    }
 
 private:
     /**
@@ -206,7 +226,14 @@ public:
      * @param useMP use an algorithm for multiple processors.
      */
     void reduce(int i, bool useMP = false) {
-        if (useMP) {
+        bool const stats = RunStatistics::enabled();
+        double const startTime = stats ? getWallClockTime() : 0;
+        size_t const m = input[i].size();
+
+        if (inPlace) {
+            reduceInPlace_(i, useMP);
+        }
+        else if (useMP) {
             reduceMP_(i);
         }
         else if (ARITY == 2) {
@@ -215,6 +242,18 @@ public:
         else {
             reduce_(i);
         }
+
+        if (stats) {
+            RunStatistics::Level rec("reduce", i);
+            MyVector<NodeId> const& newId = newIdTable[i];
+            for (size_t j = 0; j < m; ++j) {
+                if (newId[j].row() < i) ++rec.dead;
+            }
+            rec.generated = m;
+            rec.nodes = rec.unique = output[i].size();
+            rec.merged = m - rec.dead - rec.nodes;
+            RunStatistics::record(rec, startTime);
+        }
     }
 
 private:
@@ -560,6 +599,153 @@ private:
 #endif // _OPENMP
     }
 
+    /**
+     * Reduces one level in place.
+     * The surviving nodes are numbered in the order of their first
+     * occurrences.
+     * The MP version divides them into tasks by their hash codes,
+     * numbers them in each task, and shifts the numbers by the prefix sums
+     * of the task sizes; the serial version, which is the case of one task,
+     * compacts the nodes within the row.
+     * @param i level.
+     * @param useMP use an algorithm for multiple processors.
+     */
+    void reduceInPlace_(int i, bool useMP) {
+        size_t const m = input[i].size();
+        Node<ARITY>* const tt = input[i].data();
+        MyVector<NodeId>& newId = newIdTable[i];
+        newId.resize(m);
+#ifdef _OPENMP
+        int const nt = useMP ? tasks : 1;
+#else
+        int const nt = 1;
+#endif
+
+        if (nt == 1) {
+            MyHashTable<Node<ARITY> const*> uniq(m * 2);
+            size_t jj = 0;
+
+            for (size_t j = 0; j < m; ++j) {
+                if (makeCanonical(tt[j])) { // tt[j] is redundant
+                    newId[j] = tt[j].branch[0];
+                    continue;
+                }
+
+                tt[jj] = tt[j];
+                Node<ARITY> const* pp = uniq.add(&tt[jj]);
+                newId[j] = NodeId(i, pp - tt, pp->branch[0].hasEmpty());
+                if (pp == &tt[jj]) ++jj;
+            }
+
+            // truncated without reallocation until the end
+            input[i].erase(tt + jj, tt + m);
+        }
+#ifdef _OPENMP
+        else {
+            MyVector<MyVector<MyVector<size_t> > > taskq(threads);
+            for (int y = 0; y < threads; ++y) {
+                taskq[y].resize(nt);
+            }
+            MyVector<Node<ARITY> > row;
+
+#pragma omp parallel
+            {
+                int y = omp_get_thread_num();
+
+#pragma omp for schedule(static)
+                for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                    if (makeCanonical(tt[j])) { // tt[j] is redundant
+                        newId[j] = tt[j].branch[0];
+                        continue;
+                    }
+                    taskq[y][tt[j].hash() % nt].push_back(j);
+                }
+
+                MyHashTable<Node<ARITY> const*> uniq;
+
+#pragma omp for schedule(dynamic)
+                for (int x = 0; x < nt; ++x) {
+                    size_t mm = 0;
+                    for (int yy = 0; yy < threads; ++yy) {
+                        mm += taskq[yy][x].size();
+                    }
+                    baseColumn[x + 1] = 0;
+                    if (mm == 0) continue;
+
+                    uniq.initialize(mm * 2);
+                    size_t jj = 0;
+
+                    // the chunks of the threads are in the order of columns
+                    for (int yy = 0; yy < threads; ++yy) {
+                        MyVector<size_t> const& q = taskq[yy][x];
+                        for (size_t k = 0; k < q.size(); ++k) {
+                            size_t const j = q[k];
+                            Node<ARITY> const* pp = uniq.add(&tt[j]);
+                            newId[j] = (pp == &tt[j]) ?
+                                    NodeId(i + x, jj++,
+                                           tt[j].branch[0].hasEmpty()) : // row += task ID
+                                    newId[pp - tt];
+                        }
+                    }
+
+                    baseColumn[x + 1] = jj;
+                }
+
+                taskq[y].clear();
+
+#pragma omp single
+                {
+                    baseColumn[0] = 0;
+                    for (int x = 1; x < nt; ++x) {
+                        baseColumn[x + 1] += baseColumn[x];
+                    }
+                    row.resize(baseColumn[nt]);
+                }
+
+#pragma omp for schedule(static)
+                for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                    NodeId& ff = newId[j];
+                    if (ff.row() >= i) {
+                        ff = NodeId(i, ff.col() + baseColumn[ff.row() - i],
+                                    ff.getAttr());
+                        row[ff.col()] = tt[j];
+                    }
+                }
+            }
+
+            input[i].swap(row);
+        }
+#endif
+
+        MyVector<int> const& levels = input.lowerLevels(i);
+        for (int const* t = levels.begin(); t != levels.end(); ++t) {
+            newIdTable[*t].clear();
+        }
+
+        for (size_t k = 0; k < rootPtr[i].size(); ++k) {
+            NodeId& root = *rootPtr[i][k];
+            root = newId[root.col()];
+        }
+    }
+
+    /**
+     * Rewrites the children of a node to the new node IDs.
+     * @param f the node.
+     * @return true if @p f is redundant and is replaced by its 0-child.
+     */
+    bool makeCanonical(Node<ARITY>& f) const {
+        NodeId& f0 = f.branch[0];
+        f0 = newIdTable[f0.row()][f0.col()];
+        NodeId deletable = BDD ? f0 : 0;
+        bool del = BDD || ZDD || (f0 == 0);
+        for (int b = 1; b < ARITY; ++b) {
+            NodeId& ff = f.branch[b];
+            ff = newIdTable[ff.row()][ff.col()];
+            if (ff != deletable) del = false;
+        }
+        return del;
+    }
+
 public:
     void garbageCollect() {
         // Initialize marks
@@ -27,10 +27,18 @@
 #include <cassert>
 #include <ostream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "Node.hpp"
 #include "NodeTable.hpp"
+#include "SweepPolicy.hpp"
 #include "../util/MessageHandler.hpp"
+#include "../util/MyHashTable.hpp"
 #include "../util/MyVector.hpp"
+#include "../util/ResourceUsage.hpp"
+#include "../util/RunStatistics.hpp"
 
 namespace tdzdd {
 
@@ -38,10 +46,21 @@ namespace tdzdd {
  * On-the-fly DD cleaner.
  * Removes the nodes that are identified as equivalent to the 0-terminal
  * while top-down DD construction.
+ * Optionally, it also applies the ZDD reduction rules to the levels
+ * whose edges are completed, and reduces the whole DD in place after
+ * the construction.
+ * When to sweep is decided by a SweepPolicy.
+ * With multiple processors, large levels are swept in parallel.
  */
 template<int ARITY>
 class DdSweeper {
-    static size_t const SWEEP_RATIO = 20;
+    /// the smallest level size to sweep in parallel.
+    static size_t const MP_MIN_ROW_SIZE = 1 << 14;
+    static int const TASKS_PER_THREAD = 10;
+
+    enum Fate {
+        ALIVE, DEAD, DELETABLE
+    };
 
     NodeTableEntity<ARITY>& diagram;
     MyVector<NodeBranchId>* oneSrcPtr;
@@ -51,6 +70,15 @@ class DdSweeper {
     size_t allCount;
     size_t maxCount;
     NodeId* rootPtr;
+    bool eager;
+    bool reduction;
+    bool mp;
+    size_t sweptCount;
+    SweepPolicy* policy;
+    double lastSweepTime;
+
+    DdSweeper(DdSweeper const&);
+    DdSweeper& operator=(DdSweeper const&);
 
 public:
     /**
@@ -58,7 +86,10 @@ public:
      * @param diagram the diagram to sweep.
      */
     DdSweeper(NodeTableEntity<ARITY>& diagram) :
-            diagram(diagram), oneSrcPtr(0), allCount(0), maxCount(0), rootPtr(0) {
+            diagram(diagram), oneSrcPtr(0), allCount(0), maxCount(0), rootPtr(0),
+            eager(false), reduction(false), mp(false), sweptCount(0),
+            policy(SweepPolicy::createDefault()),
+            lastSweepTime(getWallClockTime()) {
     }
 
     /**
@@ -72,7 +103,17 @@ public:
             oneSrcPtr(&oneSrcPtr),
             allCount(0),
             maxCount(0),
-            rootPtr(0) {
+            rootPtr(0),
+            eager(false),
+            reduction(false),
+            mp(false),
+            sweptCount(0),
+            policy(SweepPolicy::createDefault()),
+            lastSweepTime(getWallClockTime()) {
+    }
+
+    ~DdSweeper() {
+        delete policy;
     }
 
     /**
@@ -83,6 +124,61 @@ public:
         rootPtr = &root;
     }
 
+    /**
+     * Makes the sweeper remove dead nodes whenever there are any,
+     * instead of waiting for them to be a certain fraction of the DD.
+     * @param flag true to sweep eagerly.
+     */
+    void setEager(bool flag = true) {
+        eager = flag;
+    }
+
+    /**
+     * Makes the sweeper compact large levels with multiple processors.
+     * It has no effect without OpenMP.
+     * @param flag true to use multiple processors.
+     */
+    void useMultiProcessors(bool flag = true) {
+        mp = flag;
+    }
+
+    /**
+     * Sets the policy on when to sweep.
+     * @param p the policy to be copied.
+     */
+    void setPolicy(SweepPolicy const& p) {
+        SweepPolicy* q = p.clone();
+        delete policy;
+        policy = q;
+    }
+
+    /**
+     * Makes the sweeper also delete the nodes whose non-0 edges all point
+     * to the 0-terminal and share the nodes with the same edges.
+     * Then the count given to update(int, int, size_t) should be
+     * the number of such deletable nodes instead of dead ones.
+     * @param flag true to apply the ZDD reduction rules.
+     */
+    void setReduction(bool flag = true) {
+        reduction = flag;
+    }
+
+    /**
+     * Checks if the ZDD reduction rules are applied.
+     * @return true if they are applied.
+     */
+    bool reducing() const {
+        return reduction;
+    }
+
+    /**
+     * Gets the number of nodes removed so far.
+     * @return the number of removed nodes.
+     */
+    size_t sweptNodes() const {
+        return sweptCount;
+    }
+
     /**
      * Updates status and sweeps the DD if necessary.
      * @param current current level.
@@ -113,46 +209,113 @@ public:
             deadCount[i] = 0;
         }
         if (maxCount < allCount) maxCount = allCount;
-        if (deadCount[k] * SWEEP_RATIO < maxCount) return;
+        if (deadCount[k] == 0) return;
+        if (!eager) {
+            SweepPolicy::Status status;
+            status.candidates = deadCount[k];
+            status.nodes = allCount;
+            status.maxNodes = maxCount;
+            status.nodeBytes = sizeof(Node<ARITY>);
+            status.reduction = reduction;
+            status.idleSeconds = getWallClockTime() - lastSweepTime;
+            if (!policy->shouldSweep(status)) return;
+        }
+
+        double const startTime = getWallClockTime();
+        SweepPolicy::Sweep result;
+        result.level = k;
+        result.candidates = deadCount[k];
+        result.before = diagram.size();
+        sweep(k, false);
+        result.after = allCount;
+        lastSweepTime = getWallClockTime();
+        result.seconds = lastSweepTime - startTime;
+        policy->swept(result);
+        deadCount[k] = 0;
+
+        if (RunStatistics::enabled()) {
+            RunStatistics::Level rec("sweep", k);
+            rec.generated = result.before;
+            rec.unique = result.candidates;
+            rec.dead = result.before - result.after;
+            rec.nodes = result.after;
+            RunStatistics::record(rec, startTime);
+        }
+    }
+
+    /**
+     * Reduces the whole DD as a ZDD in place.
+     * It must be called after all the levels are built.
+     * Each level is compacted bottom-up, and the table of new node IDs
+     * of a level is released as soon as all the levels referring to it
+     * are done, so that no second node table is needed.
+     */
+    void reduce() {
+        sweep(1, true);
+    }
 
+private:
+    /**
+     * Compacts the levels from the given one up to the top.
+     * @param k the lowest level, where all edges from the level and
+     *          above are completed.
+     * @param complete true if all the levels are completed.
+     */
+    void sweep(int k, bool complete) {
+        bool const zdd = reduction || complete;
+        // the 1-terminal can still be turned into the 0-terminal
+        bool const oneMayDie = !complete && oneSrcPtr && !oneSrcPtr->empty();
+        bool const stats = complete && RunStatistics::enabled();
         MyVector<MyVector<NodeId> > newId(diagram.numRows());
+        size_t const before = diagram.size();
+        if (complete) diagram.makeIndex();
 
         MessageHandler mh;
-        mh.begin("sweeping") << " <" << diagram.size() << "> ...";
+        mh.begin(complete ? "reduction" : "sweeping") << " <" << before
+                << "> ...";
 
         for (int i = k; i < diagram.numRows(); ++i) {
-            size_t m = diagram[i].size();
+            double const startTime = stats ? getWallClockTime() : 0;
+            size_t const m = diagram[i].size();
             newId[i].resize(m);
+            size_t dead = 0;
+            bool parallel = false;
+#ifdef _OPENMP
+            parallel = mp && m >= MP_MIN_ROW_SIZE && omp_get_max_threads() > 1;
+#endif
+            size_t const jj =
+                    parallel ? sweepRowMP(i, k, newId, zdd, oneMayDie, dead) :
+                            sweepRow(i, k, newId, zdd, oneMayDie, dead);
 
-            size_t jj = 0;
-
-            for (size_t j = 0; j < m; ++j) {
-                Node<ARITY>& p = diagram[i][j];
-                bool dead = true;
-
-                for (int b = 0; b < ARITY; ++b) {
-                    NodeId& f = p.branch[b];
-                    if (f.row() >= k) f = newId[f.row()][f.col()];
-                    if (f != 0) dead = false;
-                }
+            if (rootPtr && rootPtr->row() == i) {
+                *rootPtr = newId[i][rootPtr->col()];
+            }
 
-                if (dead) {
-                    newId[i][j] = 0;
-                }
-                else {
-                    newId[i][j] = NodeId(i, jj);
-                    diagram[i][jj] = p;
-                    ++jj;
+            if (complete) {
+                MyVector<int> const& levels = diagram.lowerLevels(i);
+                for (int const* t = levels.begin(); t != levels.end(); ++t) {
+                    newId[*t].clear();
                 }
             }
 
-            diagram[i].resize(jj);
+            if (stats) {
+                RunStatistics::Level rec("reduce", i);
+                rec.generated = m;
+                rec.dead = dead;
+                rec.nodes = rec.unique = jj;
+                rec.merged = m - dead - jj;
+                RunStatistics::record(rec, startTime);
+            }
         }
 
         if (oneSrcPtr) {
-            for (size_t i = 0; i < oneSrcPtr->size(); ++i) {
+            size_t const n = oneSrcPtr->size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (mp && n >= MP_MIN_ROW_SIZE)
+#endif
+            for (size_t i = 0; i < n; ++i) {
                 NodeBranchId& nbi = (*oneSrcPtr)[i];
-                if (nbi.row >= k) {
+                if (nbi.row >= k && !newId[nbi.row].empty()) {
                     NodeId f = newId[nbi.row][nbi.col];
                     nbi.row = f.row();
                     nbi.col = f.col();
@@ -160,10 +323,201 @@ public:
             }
         }
 
-        *rootPtr = newId[rootPtr->row()][rootPtr->col()];
-        deadCount[k] = 0;
+        if (complete) diagram.deleteIndex();
         allCount = diagram.size();
-        mh.end(diagram.size());
+        sweptCount += before - allCount;
+        mh.end(allCount);
+    }
+
+    /**
+     * Remaps the children of the nodes at a level and compacts the level.
+     * @param i the level.
+     * @param k the lowest level being swept.
+     * @param newId new node IDs of the levels from k up to i - 1,
+     *          to which those of level i are written.
+     * @param zdd true to apply the ZDD reduction rules.
+     * @param oneMayDie true if the 1-terminal must not be shared.
+     * @param dead incremented by the number of removed nodes.
+     * @return the new size of the level.
+     */
+    size_t sweepRow(int i, int k, MyVector<MyVector<NodeId> >& newId,
+                    bool zdd, bool oneMayDie, size_t& dead) {
+        size_t const m = diagram[i].size();
+        Node<ARITY>* const row = diagram[i].data();
+        MyHashTable<Node<ARITY> const*> uniq(zdd ? m * 2 : 1);
+        size_t jj = 0;
+
+        for (size_t j = 0; j < m; ++j) {
+            Node<ARITY>& p = row[j];
+
+            switch (remap(p, k, newId, zdd, oneMayDie)) {
+            case DEAD:
+                newId[i][j] = 0;
+                ++dead;
+                break;
+            case DELETABLE:
+                newId[i][j] = p.branch[0];
+                ++dead;
+                break;
+            default:
+                row[jj] = p;
+                Node<ARITY> const* pp = zdd ? uniq.add(&row[jj]) : &row[jj];
+                size_t const jjj = pp - row;
+                newId[i][j] = NodeId(i, jjj, zdd && pp->branch[0].hasEmpty());
+                if (jjj == jj) ++jj;
+            }
+        }
+
+        diagram[i].resize(jj);
+        return jj;
+    }
+
+    /**
+     * Parallel version of sweepRow.
+     * The nodes are remapped in parallel, and the surviving ones are
+     * numbered per thread (or per hash task for sharing) with the row
+     * of a temporary ID holding the thread (task) number.
+     * The new columns are then given by the prefix sums of the counts.
+     */
+    size_t sweepRowMP(int i, int k, MyVector<MyVector<NodeId> >& newId,
+                      bool zdd, bool oneMayDie, size_t& dead) {
+#ifndef _OPENMP
+        return sweepRow(i, k, newId, zdd, oneMayDie, dead);
+#else
+        size_t const m = diagram[i].size();
+        Node<ARITY>* const row = diagram[i].data();
+        NodeId* const ids = newId[i].data();
+        int const threads = omp_get_max_threads();
+        int const tasks =
+                zdd ? MyHashConstant::primeSize(TASKS_PER_THREAD * threads) :
+                        threads;
+        // taskq[y][x] lists the nodes of task x found by thread y
+        MyVector<MyVector<MyVector<size_t> > > taskq(zdd ? threads : 0);
+        for (int y = 0; y < int(taskq.size()); ++y) {
+            taskq[y].resize(tasks);
+        }
+        MyVector<size_t> baseColumn(tasks + 1);
+        for (int x = 0; x <= tasks; ++x) {
+            baseColumn[x] = 0;
+        }
+        MyVector<Node<ARITY> > newRow;
+        size_t deadCount = 0;
+
+#pragma omp parallel reduction(+:deadCount)
+        {
+            int const y = omp_get_thread_num();
+            size_t jj = 0;
+
+            // contiguous chunks in the order of threads
+#pragma omp for schedule(static)
+            for (size_t j = 0; j < m; ++j) {
+                Node<ARITY>& p = row[j];
+
+                switch (remap(p, k, newId, zdd, oneMayDie)) {
+                case DEAD:
+                    ids[j] = 0;
+                    ++deadCount;
+                    break;
+                case DELETABLE:
+                    ids[j] = p.branch[0];
+                    ++deadCount;
+                    break;
+                default:
+                    if (zdd) {
+                        taskq[y][p.hash() % tasks].push_back(j);
+                    }
+                    else {
+                        ids[j] = NodeId(i + y, jj++); // row += thread ID
+                    }
+                }
+            }
+
+            if (zdd) {
+                MyHashTable<Node<ARITY> const*> uniq;
+
+#pragma omp for schedule(dynamic)
+                for (int x = 0; x < tasks; ++x) {
+                    size_t mm = 0;
+                    for (int yy = 0; yy < threads; ++yy) {
+                        mm += taskq[yy][x].size();
+                    }
+                    if (mm == 0) continue;
+
+                    uniq.initialize(mm * 2);
+                    size_t jjj = 0;
+
+                    for (int yy = 0; yy < threads; ++yy) {
+                        MyVector<size_t> const& q = taskq[yy][x];
+                        for (size_t t = 0; t < q.size(); ++t) {
+                            Node<ARITY> const* p = &row[q[t]];
+                            Node<ARITY> const* pp = uniq.add(p);
+
+                            if (pp == p) { // row += task ID
+                                ids[q[t]] = NodeId(i + x, jjj++,
+                                                   p->branch[0].hasEmpty());
+                            }
+                            else { // row += tasks + task ID
+                                NodeId f = ids[pp - row];
+                                ids[q[t]] = NodeId(f.row() + tasks, f.col(),
+                                                   f.getAttr());
+                            }
+                        }
+                    }
+
+                    baseColumn[x + 1] = jjj;
+                }
+            }
+            else {
+                baseColumn[y + 1] = jj;
+            }
+
+#pragma omp barrier
+#pragma omp single
+            {
+                for (int x = 1; x < tasks; ++x) {
+                    baseColumn[x + 1] += baseColumn[x];
+                }
+                newRow.resize(baseColumn[tasks]);
+            }
+
+#pragma omp for schedule(static)
+            for (size_t j = 0; j < m; ++j) {
+                NodeId& f = ids[j];
+                if (f.row() < i) continue;
+                int x = f.row() - i;
+                bool const copy = x < tasks;
+                if (!copy) x -= tasks;
+                f = NodeId(i, f.col() + baseColumn[x], f.getAttr());
+                if (copy) newRow[f.col()] = row[j];
+            }
+        }
+
+        diagram[i].swap(newRow);
+        dead += deadCount;
+        return diagram[i].size();
+#endif // _OPENMP
+    }
+
+    /**
+     * Remaps the children of a node at the level being swept.
+     * @return the fate of the node.
+     */
+    Fate remap(Node<ARITY>& p, int k, MyVector<MyVector<NodeId> > const& newId,
+               bool zdd, bool oneMayDie) const {
+        bool allZero = true;
+        bool del = zdd;
+
+        for (int b = 0; b < ARITY; ++b) {
+            NodeId& f = p.branch[b];
+            if (f.row() >= k) f = newId[f.row()][f.col()];
+            if (f != 0) {
+                allZero = false;
+                if (b > 0) del = false;
+            }
+        }
+        if (oneMayDie && p.branch[0] == 1) del = false;
+
+        return allZero ? DEAD : del ? DELETABLE : ALIVE;
     }
 };
 
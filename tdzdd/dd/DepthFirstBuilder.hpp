@@ -0,0 +1,447 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "DdBuilder.hpp"
+#include "Node.hpp"
+#include "NodeTable.hpp"
+#include "../util/MyHashTable.hpp"
+#include "../util/MyList.hpp"
+#include "../util/MyVector.hpp"
+
+namespace tdzdd {
+
+/**
+ * Options of the depth-first ZDD construction.
+ */
+struct DepthFirstMode {
+    size_t memoCapacity; ///< The maximum number of states in the memo.
+    bool hybrid;         ///< Whether to expand the wide levels breadth-first.
+
+    /**
+     * Constructor.
+     * @param memoCapacity the maximum number of states in the memo.
+     * @param hybrid expand the wide levels breadth-first.
+     */
+    explicit DepthFirstMode(size_t memoCapacity = 1000000,
+            bool hybrid = false) :
+            memoCapacity(memoCapacity), hybrid(hybrid) {
+    }
+};
+
+/**
+ * Depth-first builder of reduced ZDDs.
+ * Each state is expanded recursively, and the node made for it is
+ * shared through the unique table of its level, so that the result is
+ * the same reduced ZDD as DdBuilder followed by zddReduce().
+ * Only the states on the current path are kept besides a memo of
+ * (level, state) pairs that maps the states already built to their nodes.
+ * The memo holds a bounded number of states and evicts them by the
+ * CLOCK algorithm, so that an evicted state is built again when it is
+ * reached again; the capacity trades recomputation for memory.
+ *
+ * In the hybrid mode, the levels are expanded breadth-first from the top
+ * as DdBuilder does, which shares all the equivalent states of a level
+ * without recomputation, until a level has at most half the states of
+ * the widest level so far, and the memo could hold as many states for
+ * each level below, that is, all the states below if the levels get no
+ * wider.
+ * The states there and below are then built depth-first,
+ * and the upper levels are resolved bottom-up.
+ *
+ * merge_states(void*, void*) is not supported; equivalent states are
+ * always shared.
+ */
+template<typename S>
+class DepthFirstBuilder: DdBuilderBase {
+    typedef S Spec;
+    typedef MyHashTable<SpecNode*,Hasher<Spec>,Hasher<Spec> > UniqStateTable;
+    typedef MyHashMap<InitializedNode<Spec::ARITY>,size_t> UniqNodeTable;
+    static int const AR = Spec::ARITY;
+
+    /* A state in the memo with its node.
+     */
+    struct Slot {
+        SpecNode* snode;
+        size_t hash;
+        size_t next;
+        NodeId f;
+        int level;
+        bool ref;
+    };
+
+    static size_t const NIL = size_t(-1);
+
+    Spec spec;
+    int const specNodeSize;
+    NodeTableEntity<AR>& output;
+    MyVector<UniqNodeTable> uniq;
+    MyList<SpecNode> statePool;
+
+    size_t const memoCapacity;
+    bool const hybrid;
+    MyList<SpecNode> memoPool;
+    MyVector<Slot> slots;
+    MyVector<size_t> buckets;
+    size_t hand;
+
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    int depthFirstLevel_;
+
+public:
+    /**
+     * Constructor.
+     * @param spec the spec.
+     * @param output the node table to store the ZDD.
+     * @param mode the options of the construction.
+     */
+    DepthFirstBuilder(Spec const& spec, NodeTableEntity<AR>& output,
+            DepthFirstMode const& mode = DepthFirstMode()) :
+            spec(spec), specNodeSize(getSpecNodeSize(spec.datasize())),
+            output(output), memoCapacity(mode.memoCapacity),
+            hybrid(mode.hybrid), hand(0), hits(0), misses(0), evictions(0),
+            depthFirstLevel_(0) {
+    }
+
+    ~DepthFirstBuilder() {
+        clearMemo();
+    }
+
+    /**
+     * Builds the reduced ZDD.
+     * @param root reference to the root ID to be set.
+     * @return the number of levels of the spec.
+     */
+    int construct(NodeId& root) {
+        SpecNode* p = statePool.alloc_front(specNodeSize);
+        int n = spec.get_root(state(p));
+
+        if (n <= 0) {
+            root = n ? 1 : 0;
+            n = 0;
+        }
+        else {
+            output.init(n + 1);
+            uniq.clear();
+            uniq.resize(n + 1);
+            depthFirstLevel_ = hybrid ? 0 : n;
+            root = hybrid ? buildHybrid(p, n) : build(state(p), n);
+
+            clearMemo();
+            uniq.clear();
+            for (int i = n; i >= 1; --i) {
+                spec.destructLevel(i);
+            }
+        }
+
+        spec.destruct(state(p));
+        statePool.pop_front();
+        return n;
+    }
+
+    /**
+     * Gets the number of states found in the memo.
+     * @return the number of hits.
+     */
+    size_t memoHits() const {
+        return hits;
+    }
+
+    /**
+     * Gets the number of states built, including those built again.
+     * @return the number of misses.
+     */
+    size_t memoMisses() const {
+        return misses;
+    }
+
+    /**
+     * Gets the number of states evicted from the memo.
+     * @return the number of evictions.
+     */
+    size_t memoEvictions() const {
+        return evictions;
+    }
+
+    /**
+     * Gets the highest level built depth-first,
+     * which is lower than the root level only in the hybrid mode,
+     * or 0 if all the levels are built breadth-first.
+     * @return the level.
+     */
+    int depthFirstLevel() const {
+        return depthFirstLevel_;
+    }
+
+private:
+    NodeId build(void const* s, int i) {
+        size_t h = spec.hash_code(s, i) + size_t(i) * 271828171;
+        NodeId f;
+        if (memoFind(s, i, h, f)) {
+            ++hits;
+            return f;
+        }
+        ++misses;
+
+        void* const ss = state(statePool.alloc_front(specNodeSize));
+        Node<AR> q;
+
+        for (int b = 0; b < AR; ++b) {
+            spec.get_copy(ss, s);
+            int ii = spec.get_child(ss, i, b);
+            if (ii <= 0) {
+                q.branch[b] = ii ? 1 : 0;
+            }
+            else {
+                assert(ii < i);
+                q.branch[b] = build(ss, ii);
+            }
+            spec.destruct(ss);
+        }
+
+        statePool.pop_front();
+        f = makeNode(i, q);
+        memoAdd(s, i, h, f);
+        return f;
+    }
+
+    NodeId makeNode(int i, Node<AR> const& q) {
+        bool zero = true;
+        for (int b = 1; b < AR; ++b) {
+            if (q.branch[b] != 0) {
+                zero = false;
+                break;
+            }
+        }
+        if (zero) return q.branch[0];
+
+        size_t& j = uniq[i][InitializedNode<AR>(q)];
+        if (j == 0) {
+            output[i].push_back(q);
+            j = output[i].size(); // shifted by one to tell the new entry
+        }
+        return NodeId(i, j - 1);
+    }
+
+    NodeId buildHybrid(SpecNode* root, int n) {
+        MyVector<MyList<SpecNode> > snodeTable(n + 1);
+        MyVector<MyVector<Node<AR> > > bfNodes(n + 1);
+        MyVector<MyVector<NodeId> > resolved(n + 1);
+        MyVector<char> tmp(spec.datasize());
+        void* const tmpState = tmp.data();
+        NodeId f;
+        size_t maxWidth = 0;
+        bool depthFirst = false;
+
+        schedule(snodeTable, &f, n, state(root));
+
+        for (int i = n; i >= 1; --i) {
+            MyList<SpecNode>& snodes = snodeTable[i];
+            if (snodes.empty()) continue;
+
+            Hasher<Spec> hasher(spec, i);
+            UniqStateTable table(snodes.size() * 2, hasher, hasher);
+            size_t m = 0;
+
+            for (MyList<SpecNode>::iterator t = snodes.begin();
+                    t != snodes.end(); ++t) {
+                SpecNode* p = *t;
+                SpecNode* p0 = table.add(p);
+                if (p0 == p) {
+                    nodeId(p) = *srcPtr(p) = NodeId(i, m++);
+                }
+                else {
+                    *srcPtr(p) = nodeId(p0);
+                    nodeId(p) = 1; // unused
+                }
+            }
+
+            if (!depthFirst && m * 2 <= maxWidth && m * i <= memoCapacity) {
+                depthFirst = true;
+                depthFirstLevel_ = i;
+            }
+
+            if (depthFirst) {
+                resolved[i].resize(m);
+                for (MyList<SpecNode>::iterator t = snodes.begin();
+                        t != snodes.end(); ++t) {
+                    SpecNode* p = *t;
+                    if (nodeId(p).row() == i) {
+                        resolved[i][nodeId(p).col()] = build(state(p), i);
+                    }
+                }
+            }
+            else {
+                MyVector<Node<AR> >& nodes = bfNodes[i];
+                nodes.resize(m);
+                for (MyList<SpecNode>::iterator t = snodes.begin();
+                        t != snodes.end(); ++t) {
+                    SpecNode* p = *t;
+                    if (nodeId(p).row() != i) continue;
+                    Node<AR>& q = nodes[nodeId(p).col()];
+
+                    for (int b = 0; b < AR; ++b) {
+                        spec.get_copy(tmpState, state(p));
+                        int ii = spec.get_child(tmpState, i, b);
+                        if (ii <= 0) {
+                            q.branch[b] = ii ? 1 : 0;
+                        }
+                        else {
+                            assert(ii < i);
+                            schedule(snodeTable, &q.branch[b], ii, tmpState);
+                        }
+                        spec.destruct(tmpState);
+                    }
+                }
+                maxWidth = std::max(maxWidth, m);
+            }
+
+            for (MyList<SpecNode>::iterator t = snodes.begin();
+                    t != snodes.end(); ++t) {
+                spec.destruct(state(*t));
+            }
+            snodes.clear();
+        }
+
+        for (int i = 1; i <= n; ++i) {
+            MyVector<Node<AR> >& nodes = bfNodes[i];
+            if (nodes.empty()) continue;
+            resolved[i].resize(nodes.size());
+
+            for (size_t j = 0; j < nodes.size(); ++j) {
+                Node<AR>& q = nodes[j];
+                for (int b = 0; b < AR; ++b) {
+                    NodeId g = q.branch[b];
+                    if (g.row() > 0) q.branch[b] = resolved[g.row()][g.col()];
+                }
+                resolved[i][j] = makeNode(i, q);
+            }
+
+            nodes.clear();
+        }
+
+        return (f.row() > 0) ? resolved[f.row()][f.col()] : f;
+    }
+
+    void schedule(MyVector<MyList<SpecNode> >& snodeTable, NodeId* fp,
+            int i, void* s) {
+        SpecNode* p = snodeTable[i].alloc_front(specNodeSize);
+        spec.get_copy(state(p), s);
+        srcPtr(p) = fp;
+    }
+
+    bool memoFind(void const* s, int i, size_t h, NodeId& f) {
+        if (buckets.empty()) return false;
+
+        for (size_t k = buckets[h % buckets.size()]; k != NIL;
+                k = slots[k].next) {
+            Slot& slot = slots[k];
+            if (slot.hash == h && slot.level == i
+                    && spec.equal_to(state(slot.snode), s, i)) {
+                slot.ref = true;
+                f = slot.f;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void memoAdd(void const* s, int i, size_t h, NodeId f) {
+        if (memoCapacity == 0) return;
+        size_t k;
+
+        if (slots.size() < memoCapacity) {
+            if (slots.size() >= buckets.size()) {
+                rehash(MyHashConstant::primeSize(
+                        std::min(slots.size() * 2 + 1, memoCapacity)));
+            }
+            k = slots.size();
+            slots.push_back(Slot());
+            slots[k].snode = memoPool.alloc_front(specNodeSize);
+        }
+        else {
+            while (slots[hand].ref) {
+                slots[hand].ref = false;
+                if (++hand == slots.size()) hand = 0;
+            }
+            k = hand;
+            if (++hand == slots.size()) hand = 0;
+            unlink(k);
+            spec.destruct(state(slots[k].snode));
+            ++evictions;
+        }
+
+        Slot& slot = slots[k];
+        spec.get_copy(state(slot.snode), s);
+        slot.hash = h;
+        slot.f = f;
+        slot.level = i;
+        slot.ref = false;
+        size_t& head = buckets[h % buckets.size()];
+        slot.next = head;
+        head = k;
+    }
+
+    void unlink(size_t k) {
+        size_t* kp = &buckets[slots[k].hash % buckets.size()];
+        while (*kp != k) {
+            assert(*kp != NIL);
+            kp = &slots[*kp].next;
+        }
+        *kp = slots[k].next;
+    }
+
+    void rehash(size_t size) {
+        buckets.clear();
+        buckets.resize(size);
+        for (size_t j = 0; j < size; ++j) {
+            buckets[j] = NIL;
+        }
+        for (size_t k = 0; k < slots.size(); ++k) {
+            size_t& head = buckets[slots[k].hash % size];
+            slots[k].next = head;
+            head = k;
+        }
+    }
+
+    void clearMemo() {
+        for (size_t k = 0; k < slots.size(); ++k) {
+            spec.destruct(state(slots[k].snode));
+        }
+        slots.clear();
+        buckets.clear();
+        memoPool.clear();
+        hand = 0;
+    }
+};
+
+} // namespace tdzdd
@@ -0,0 +1,358 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cassert>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../util/demangle.hpp"
+#include "../util/MessageHandler.hpp"
+#include "../util/MyHashTable.hpp"
+#include "../util/MyList.hpp"
+
+namespace tdzdd {
+
+/**
+ * Searcher for one instance of a spec, which also proves that
+ * no instance exists.
+ * The search is depth-first, and learns the dead states: a state whose
+ * subtree is searched through without an instance is remembered with its
+ * level as a no-good, and is not searched again.
+ * With multiple processors, the threads run a portfolio of searches,
+ * and the first thread that finds an instance or proves that none exists
+ * stops the others. The threads 2k and 2k+1 take the 1-branches first
+ * (k = 0), the 0-branches first (k = 1), or random branches first (k > 1).
+ * The even threads search exhaustively, which learns the most no-goods.
+ * The odd threads limit the number of discrepancies, the branches taken
+ * against the preferred order, and deepen the limit iteratively
+ * (0, 1, 2, 4, ...), so that the instances near the preferred branches
+ * are found first; only the subtrees searched through within the limit
+ * are learned, the no-goods are kept across the iterations, and the last
+ * iteration is exhaustive.
+ * Without multiple processors, only the thread 0 runs.
+ * If the spec reports a level by is_forced_zero(void const*, int),
+ * only the 0-branch is searched there.
+ * merge_states(void*, void*) is not supported.
+ */
+template<typename S>
+class FeasibilitySearcher {
+    typedef S Spec;
+    static int const AR = Spec::ARITY;
+
+    enum Result {
+        FOUND, DEAD, CUTOFF
+    };
+
+    /* SpecNode
+     * ┌────────┬────────┬────────┬─────
+     * │ level  │state[0]│state[1]│ ...
+     * └────────┴────────┴────────┴─────
+     */
+    union SpecNode {
+        int64_t code;
+        int level;
+    };
+
+    static int& level(SpecNode* p) {
+        return p[0].level;
+    }
+
+    static int level(SpecNode const* p) {
+        return p[0].level;
+    }
+
+    static void* state(SpecNode* p) {
+        return p + 1;
+    }
+
+    static void const* state(SpecNode const* p) {
+        return p + 1;
+    }
+
+    struct Hasher {
+        Spec const& spec;
+
+        explicit Hasher(Spec const& spec) :
+                spec(spec) {
+        }
+
+        size_t operator()(SpecNode const* p) const {
+            return spec.hash_code(state(p), level(p))
+                    + size_t(level(p)) * 271828171;
+        }
+
+        bool operator()(SpecNode const* p, SpecNode const* q) const {
+            return level(p) == level(q)
+                    && spec.equal_to(state(p), state(q), level(p));
+        }
+    };
+
+    typedef MyHashTable<SpecNode*,Hasher,Hasher> NoGoodTable;
+
+    /* Search of one thread.
+     */
+    class Worker {
+        Spec spec;
+        int const specNodeSize;
+        size_t const noGoodLimit;
+        int const order; // 0: 1-branches first, 1: 0-branches first, 2: random
+        bool const deepening;
+        uint64_t random;
+        bool volatile& done;
+
+        MyList<SpecNode> statePool;
+        MyList<SpecNode> noGoodPool;
+        NoGoodTable noGoods;
+        size_t steps;
+        bool stopped;
+
+    public:
+        std::vector<std::pair<int,int> > instance;
+        size_t noGoodCount;
+        int discrepancies;
+
+        Worker(Spec const& spec, size_t noGoodLimit, int y, bool volatile& done) :
+                spec(spec),
+                specNodeSize(1 + (spec.datasize() + sizeof(SpecNode) - 1)
+                        / sizeof(SpecNode)),
+                noGoodLimit(noGoodLimit), order(y / 2 < 2 ? y / 2 : 2),
+                deepening(y % 2 != 0),
+                random(0x9E3779B97F4A7C15ULL * (y + 1)), done(done),
+                noGoods(Hasher(this->spec), Hasher(this->spec)), steps(0),
+                stopped(false), noGoodCount(0), discrepancies(0) {
+        }
+
+        ~Worker() {
+            clearNoGoods();
+        }
+
+        /*
+         * Returns FOUND or DEAD, or CUTOFF if stopped by another thread.
+         */
+        Result run() {
+            SpecNode* p = statePool.alloc_front(specNodeSize);
+            int n = spec.get_root(state(p));
+            Result r;
+
+            if (n <= 0) {
+                r = n ? FOUND : DEAD;
+            }
+            else {
+                instance.reserve(n);
+                discrepancies = deepening ? 0 : n;
+                while (true) {
+                    r = step(state(p), n, discrepancies);
+                    if (r != CUTOFF || discrepancies >= n || isDone()) break;
+                    discrepancies = discrepancies ? discrepancies * 2 : 1;
+                    if (discrepancies > n) discrepancies = n;
+                }
+                for (int i = n; i >= 1; --i) {
+                    spec.destructLevel(i);
+                }
+            }
+
+            spec.destruct(state(p));
+            statePool.pop_front();
+            return r;
+        }
+
+    private:
+        Result step(void const* s, int i, int d) {
+            if ((++steps & 1023) == 0 && isDone()) stopped = true;
+            if (stopped) return CUTOFF;
+            if (isNoGood(s, i)) return DEAD;
+
+            int b0 = AR - 1;
+            int db = -1;
+            if (order == 1) {
+                b0 = 0;
+                db = 1;
+            }
+            else if (order == 2) {
+                b0 = int(nextRandom() % AR);
+                db = 1;
+            }
+            bool const forced = spec.is_forced_zero(s, i);
+            SpecNode* pp = statePool.alloc_front(specNodeSize);
+            bool cut = false;
+            Result r = DEAD;
+            int tried = 0;
+
+            for (int k = 0; k < AR; ++k) {
+                int b = (b0 + db * k + AR) % AR;
+                if (forced && b != 0) continue;
+                if (tried++ > 0 && d == 0) {
+                    cut = true;
+                    break;
+                }
+
+                spec.get_copy(state(pp), s);
+                int ii = spec.get_child(state(pp), i, b);
+                if (ii <= 0) {
+                    r = ii ? FOUND : DEAD;
+                }
+                else {
+                    assert(ii < i);
+                    r = step(state(pp), ii, tried > 1 ? d - 1 : d);
+                }
+                spec.destruct(state(pp));
+
+                if (r == FOUND) {
+                    instance.push_back(std::make_pair(i, b));
+                    break;
+                }
+                if (r == CUTOFF) cut = true;
+            }
+
+            statePool.pop_front();
+            if (r == FOUND) return FOUND;
+            if (cut) return CUTOFF;
+            addNoGood(s, i);
+            return DEAD;
+        }
+
+        bool isNoGood(void const* s, int i) {
+            if (noGoods.empty()) return false;
+            SpecNode* p = statePool.alloc_front(specNodeSize);
+            level(p) = i;
+            spec.get_copy(state(p), s);
+            bool found = noGoods.get(p) != 0;
+            spec.destruct(state(p));
+            statePool.pop_front();
+            return found;
+        }
+
+        void addNoGood(void const* s, int i) {
+            if (noGoods.size() >= noGoodLimit) clearNoGoods();
+            SpecNode* p = noGoodPool.alloc_front(specNodeSize);
+            level(p) = i;
+            spec.get_copy(state(p), s);
+            noGoods.add(p);
+            ++noGoodCount;
+        }
+
+        void clearNoGoods() {
+            for (typename MyList<SpecNode>::iterator t = noGoodPool.begin();
+                    t != noGoodPool.end(); ++t) {
+                spec.destruct(state(*t));
+            }
+            noGoodPool.clear();
+            noGoods.clear();
+        }
+
+        uint64_t nextRandom() {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            return random;
+        }
+
+        bool isDone() const {
+            bool d;
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+            d = done;
+            return d;
+        }
+    };
+
+    Spec const& spec;
+    size_t noGoodLimit;
+    bool useMP;
+
+public:
+    /**
+     * Constructor.
+     * @param spec the spec.
+     * @param useMP use the portfolio search on multiple processors.
+     * @param noGoodLimit the maximum number of no-goods for each thread,
+     *        which are forgotten all together when the limit is reached.
+     */
+    explicit FeasibilitySearcher(Spec const& spec, bool useMP = false,
+            size_t noGoodLimit = 4000000) :
+            spec(spec), noGoodLimit(noGoodLimit), useMP(useMP) {
+    }
+
+    /**
+     * Searches for an instance.
+     * @param instance the collection of (item, value) pairs to be set
+     *        to the instance found.
+     * @return false if no instance exists.
+     */
+    bool search(std::vector<std::pair<int,int> >& instance) {
+        MessageHandler mh;
+        mh.begin(typenameof(spec));
+        mh << " feasibility";
+        bool volatile done = false;
+        Result result = CUTOFF;
+        size_t noGoodCount = 0;
+        int discrepancies = -1;
+
+#ifdef _OPENMP
+        int const threads = useMP ? omp_get_max_threads() : 1;
+        if (threads > 1) mh << " " << threads << "x";
+#pragma omp parallel num_threads(threads)
+#endif
+        {
+#ifdef _OPENMP
+            int y = omp_get_thread_num();
+#else
+            int y = 0;
+#endif
+            Worker w(spec, noGoodLimit, y, done);
+            Result r = w.run();
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            if (r != CUTOFF && result == CUTOFF) {
+                result = r;
+                instance = w.instance;
+                noGoodCount = w.noGoodCount;
+                if (y % 2 != 0) discrepancies = w.discrepancies;
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                done = true;
+            }
+        }
+
+        assert(result != CUTOFF);
+        if (discrepancies >= 0) mh << ", " << discrepancies << " discrepancies";
+        mh << ", " << noGoodCount << " no-goods";
+        mh.end(result == FOUND ? "found" : "no instance");
+        return result == FOUND;
+    }
+};
+
+} // namespace tdzdd
@@ -0,0 +1,252 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace tdzdd {
+
+/**
+ * Policy of DdSweeper on when to sweep.
+ * A sweep scans all the levels above the lowest completed one,
+ * so that it takes time proportional to the size of the DD,
+ * and removes the dead (or deletable) nodes counted so far.
+ * A DdSweeper asks its policy after every level and reports every sweep
+ * to it, so that a policy can adapt itself to the measured costs.
+ * New sweepers use a copy of the default policy, which is
+ * a RatioSweepPolicy unless changed by setDefault().
+ */
+class SweepPolicy {
+public:
+    /**
+     * State of the DD after a level is built.
+     */
+    struct Status {
+        size_t candidates;  ///< Nodes that a sweep would remove.
+        size_t nodes;       ///< Nodes in the DD.
+        size_t maxNodes;    ///< Maximum of the nodes so far.
+        size_t nodeBytes;   ///< Bytes of a node.
+        bool reduction;     ///< Whether sweeps apply the ZDD reduction rules.
+        double idleSeconds; ///< Time since the last sweep or the start.
+    };
+
+    /**
+     * Result of a sweep.
+     */
+    struct Sweep {
+        int level;          ///< The lowest level swept.
+        size_t candidates;  ///< Nodes expected to be removed.
+        size_t before;      ///< Nodes in the DD before the sweep.
+        size_t after;       ///< Nodes in the DD after the sweep.
+        double seconds;     ///< Time of the sweep.
+    };
+
+    virtual ~SweepPolicy() {
+    }
+
+    /**
+     * Decides whether to sweep now.
+     * @param s the state of the DD.
+     * @return true to sweep.
+     */
+    virtual bool shouldSweep(Status const& s) = 0;
+
+    /**
+     * Receives the result of a sweep.
+     * @param s the result.
+     */
+    virtual void swept(Sweep const& s) {
+    }
+
+    /**
+     * Makes a copy of this policy.
+     * @return a new object to be deleted by the caller.
+     */
+    virtual SweepPolicy* clone() const = 0;
+
+    /**
+     * Makes a policy from its description, which is one of
+     * "ratio[:<r>]", "memory:<MB>" and "cost[:<overhead>]".
+     * @param spec the description.
+     * @return a new object to be deleted by the caller.
+     * @throws std::runtime_error if the description is invalid.
+     */
+    static SweepPolicy* create(std::string const& spec);
+
+    /**
+     * Sets the default policy of new sweepers.
+     * It should not be called while DDs are being built.
+     * @param p the policy to be copied.
+     */
+    static void setDefault(SweepPolicy const& p) {
+        SweepPolicy* q = p.clone();
+        delete defaultPolicy();
+        defaultPolicy() = q;
+    }
+
+    /**
+     * Makes a copy of the default policy.
+     * @return a new object to be deleted by the caller.
+     */
+    static SweepPolicy* createDefault();
+
+private:
+    static SweepPolicy*& defaultPolicy() {
+        static SweepPolicy* p = 0;
+        return p;
+    }
+};
+
+/**
+ * Sweeps when the dead nodes are a certain fraction of the largest DD
+ * so far, or, when sweeps apply the ZDD reduction rules, when the deletable
+ * nodes are a certain fraction of the current DD, so that the sweeps for
+ * reduction wait for the DD to grow by a certain factor.
+ */
+class RatioSweepPolicy: public SweepPolicy {
+    double ratio;
+    double reductionRatio;
+
+public:
+    /**
+     * Constructor.
+     * @param ratio the fraction for dead nodes.
+     * @param reductionRatio the fraction for deletable nodes.
+     */
+    explicit RatioSweepPolicy(double ratio = 0.05,
+            double reductionRatio = 0.25) :
+            ratio(ratio), reductionRatio(reductionRatio) {
+    }
+
+    bool shouldSweep(Status const& s) {
+        return s.reduction ? s.candidates >= s.nodes * reductionRatio
+                           : s.candidates >= s.maxNodes * ratio;
+    }
+
+    SweepPolicy* clone() const {
+        return new RatioSweepPolicy(*this);
+    }
+};
+
+/**
+ * Sweeps whenever the node table exceeds a certain size.
+ */
+class MemorySweepPolicy: public SweepPolicy {
+    size_t bytes;
+
+public:
+    /**
+     * Constructor.
+     * @param bytes the size of the node table in bytes.
+     */
+    explicit MemorySweepPolicy(size_t bytes) :
+            bytes(bytes) {
+    }
+
+    bool shouldSweep(Status const& s) {
+        return s.nodes * s.nodeBytes >= bytes;
+    }
+
+    SweepPolicy* clone() const {
+        return new MemorySweepPolicy(*this);
+    }
+};
+
+/**
+ * Sweeps when the time of a sweep, estimated from the measured time per
+ * scanned node, is within a certain fraction of the time since the last
+ * sweep, and the sweep is expected to free some nodes, estimated from
+ * the measured number of removed nodes per candidate.
+ * Thus the sweeps take at most that fraction of the construction time,
+ * and are made as often as possible within it.
+ */
+class CostSweepPolicy: public SweepPolicy {
+    double overhead;
+    double secondsPerNode;
+    double freedPerCandidate;
+
+public:
+    /**
+     * Constructor.
+     * @param overhead the fraction of time to spend on sweeps.
+     */
+    explicit CostSweepPolicy(double overhead = 0.05) :
+            overhead(overhead), secondsPerNode(1e-8), freedPerCandidate(1) {
+    }
+
+    bool shouldSweep(Status const& s) {
+        if (s.candidates * freedPerCandidate < 1) return false;
+        return s.nodes * secondsPerNode <= s.idleSeconds * overhead;
+    }
+
+    void swept(Sweep const& s) {
+        // exponential moving averages
+        if (s.before > 0) {
+            secondsPerNode = (secondsPerNode + s.seconds / s.before) / 2;
+        }
+        if (s.candidates > 0) {
+            double freed = double(s.before - s.after) / s.candidates;
+            freedPerCandidate = (freedPerCandidate + freed) / 2;
+        }
+    }
+
+    SweepPolicy* clone() const {
+        return new CostSweepPolicy(*this);
+    }
+};
+
+inline SweepPolicy* SweepPolicy::create(std::string const& spec) {
+    std::string::size_type colon = spec.find(':');
+    std::string name = spec.substr(0, colon);
+    std::string arg = (colon == std::string::npos) ? "" :
+                      spec.substr(colon + 1);
+    char* end = 0;
+    double value = arg.empty() ? 0 : std::strtod(arg.c_str(), &end);
+    if (!arg.empty() && (*end != '\0' || value <= 0)) {
+        throw std::runtime_error("ERROR: " + spec + ": Invalid sweep policy");
+    }
+
+    if (name == "ratio") {
+        return arg.empty() ? new RatioSweepPolicy() :
+                             new RatioSweepPolicy(value);
+    }
+    if (name == "memory" && !arg.empty()) {
+        return new MemorySweepPolicy(size_t(value * 1048576));
+    }
+    if (name == "cost") {
+        return arg.empty() ? new CostSweepPolicy() :
+                             new CostSweepPolicy(value);
+    }
+    throw std::runtime_error("ERROR: " + spec + ": Invalid sweep policy");
+}
+
+inline SweepPolicy* SweepPolicy::createDefault() {
+    SweepPolicy* p = defaultPolicy();
+    return p ? p->clone() : new RatioSweepPolicy();
+}
+
+} // namespace tdzdd
@@ -0,0 +1,620 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <stdint.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "Node.hpp"
+#include "NodeTable.hpp"
+#include "../util/MessageHandler.hpp"
+#include "../util/MyHashTable.hpp"
+#include "../util/MyVector.hpp"
+
+namespace tdzdd {
+
+/**
+ * Recursive ZDD operations on node tables.
+ * Unlike the specs of DdSpecOp.hpp, which make the product of two specs
+ * through DdBuilder, the operations work on the reduced nodes directly
+ * with a cache of operation results.
+ * The operands are imported into the shared node store of this object,
+ * where each node is unique, and the results stay there until exported.
+ * A node store can thus serve a series of operations, and the results
+ * of one operation can be the operands of another.
+ * The levels of all the operands must stand for the same variables.
+ *
+ * With multiple processors, the top of the recursion is split into
+ * OpenMP tasks. The nodes of a level are added under a lock of the level.
+ * Each thread has a cache of its own, which needs no synchronization
+ * but may let two threads compute the same sub-operation.
+ */
+class ZddApply {
+public:
+    /// Operations.
+    enum Operation {
+        UNION,        ///< F | G.
+        INTERSECTION, ///< F & G.
+        DIFFERENCE,   ///< F - G.
+        JOIN,         ///< { a | b : a in F, b in G }.
+        MEET,         ///< { a & b : a in F, b in G }.
+        RESTRICT,     ///< { a in F : b <= a for some b in G }.
+        PERMIT,       ///< { a in F : a <= b for some b in G }.
+        ONSET,        ///< { a in F : a has the variable }.
+        OFFSET        ///< { a in F : a does not have the variable }.
+    };
+
+private:
+    /// the number of nodes in the first chunk is 2^CHUNK_BITS.
+    static int const CHUNK_BITS = 10;
+    static int const MAX_CHUNKS = NODE_COL_BITS - CHUNK_BITS + 1;
+    /// the maximum number of cache entries of a thread is 2^CACHE_BITS.
+    static int const CACHE_BITS = 24;
+    /// tasks are made up to this depth beyond log2 of the threads.
+    static int const EXTRA_TASK_DEPTH = 4;
+
+    /*
+     * The nodes of a level are stored in chunks of doubling sizes,
+     * so that adding nodes never moves the others.
+     */
+    static int chunkOf(size_t j) {
+        size_t t = (j >> CHUNK_BITS) + 1;
+#ifdef __GNUC__
+        return 63 - __builtin_clzll(t);
+#else
+        int c = 0;
+        while (t >>= 1) ++c;
+        return c;
+#endif
+    }
+
+    static Node<2>& nodeAt(Node<2>* const* chunks, size_t j) {
+        int const c = chunkOf(j);
+        return chunks[c][j - (((size_t(1) << c) - 1) << CHUNK_BITS)];
+    }
+
+    /// Hash function on the columns (+ 1) of a level.
+    struct ColumnHash {
+        Node<2>* const* chunks;
+
+        ColumnHash(Node<2>* const* chunks) :
+                chunks(chunks) {
+        }
+
+        size_t operator()(size_t k) const {
+            return nodeAt(chunks, k - 1).hash();
+        }
+
+        bool operator()(size_t k1, size_t k2) const {
+            return nodeAt(chunks, k1 - 1) == nodeAt(chunks, k2 - 1);
+        }
+    };
+
+    class Level {
+        Node<2>* chunks[MAX_CHUNKS];
+        size_t size_;
+        MyHashTable<size_t,ColumnHash,ColumnHash> uniq;
+#ifdef _OPENMP
+        omp_lock_t lock;
+#endif
+
+        Level(Level const&);
+        Level& operator=(Level const&);
+
+    public:
+        Level() :
+                size_(0), uniq(ColumnHash(chunks), ColumnHash(chunks)) {
+            for (int c = 0; c < MAX_CHUNKS; ++c) {
+                chunks[c] = 0;
+            }
+#ifdef _OPENMP
+            omp_init_lock(&lock);
+#endif
+        }
+
+        ~Level() {
+            for (int c = 0; c < MAX_CHUNKS; ++c) {
+                delete[] chunks[c];
+            }
+#ifdef _OPENMP
+            omp_destroy_lock(&lock);
+#endif
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        Node<2> const& operator[](size_t j) const {
+            return nodeAt(chunks, j);
+        }
+
+        /**
+         * Adds a node unless the same node exists.
+         * @param node the node.
+         * @param locking true if other threads may add nodes.
+         * @return the column of the node.
+         */
+        size_t add(Node<2> const& node, bool locking) {
+#ifdef _OPENMP
+            if (locking) omp_set_lock(&lock);
+#endif
+            size_t const j = size_;
+            int const c = chunkOf(j);
+            if (chunks[c] == 0) {
+                chunks[c] = new Node<2>[size_t(1) << (CHUNK_BITS + c)];
+            }
+            nodeAt(chunks, j) = node; // tentatively
+            size_t const k = uniq.add(j + 1);
+            if (k == j + 1) ++size_;
+#ifdef _OPENMP
+            if (locking) omp_unset_lock(&lock);
+#endif
+            return k - 1;
+        }
+    };
+
+    struct CacheEntry {
+        uint64_t f;
+        uint64_t g;
+        NodeId r;
+        int op;
+    };
+
+    /*
+     * The cache of a thread grows with the results that the thread stores,
+     * since a cache much smaller than the working set would make
+     * the recursion recompute the same operations over and over.
+     */
+    struct Cache {
+        MyVector<CacheEntry> table;
+        int bits;
+        size_t stores; ///< the number of results stored so far.
+
+        Cache() :
+                bits(0), stores(0) {
+        }
+
+        void resize(int newBits) {
+            MyVector<CacheEntry> old;
+            old.swap(table);
+            bits = newBits;
+            table.resize(size_t(1) << bits);
+            for (size_t k = 0; k < table.size(); ++k) {
+                table[k].op = -1;
+            }
+            for (size_t k = 0; k < old.size(); ++k) {
+                if (old[k].op >= 0) {
+                    at(old[k].op, old[k].f, old[k].g) = old[k];
+                }
+            }
+        }
+
+        CacheEntry& at(int op, uint64_t f, uint64_t g) {
+            uint64_t h = (f * 314159257 + g * 271828171 + op)
+                    * 0x9E3779B97F4A7C15ULL;
+            return table[h >> (64 - bits)];
+        }
+    };
+
+    int const threads;
+    int taskDepth;
+    MyVector<Level*> levels;
+    MyVector<Cache> caches;
+
+    ZddApply(ZddApply const&);
+    ZddApply& operator=(ZddApply const&);
+
+public:
+    /**
+     * Constructor.
+     * @param useMP use multiple processors.
+     */
+    ZddApply(bool useMP = false) :
+#ifdef _OPENMP
+            threads(useMP ? omp_get_max_threads() : 1),
+#else
+            threads(1),
+#endif
+            taskDepth(0), levels(1), caches(threads) {
+        levels[0] = 0;
+        if (threads >= 2) {
+            taskDepth = EXTRA_TASK_DEPTH;
+            for (int y = threads - 1; y > 0; y >>= 1) {
+                ++taskDepth;
+            }
+        }
+    }
+
+    ~ZddApply() {
+        for (size_t i = 0; i < levels.size(); ++i) {
+            delete levels[i];
+        }
+    }
+
+    /**
+     * Gets the number of nonterminal nodes in the node store.
+     * @return the number of nodes.
+     */
+    size_t size() const {
+        size_t n = 0;
+        for (size_t i = 1; i < levels.size(); ++i) {
+            n += levels[i]->size();
+        }
+        return n;
+    }
+
+    /**
+     * Imports a ZDD into the node store.
+     * The ZDD need not be reduced.
+     * @param table the node table of the ZDD.
+     * @param root the root node in the table.
+     * @return the root node in the node store.
+     */
+    NodeId import(NodeTableEntity<2> const& table, NodeId root) {
+        int const n = root.row();
+        while (int(levels.size()) <= n) {
+            levels.push_back(new Level);
+        }
+
+        MyVector<MyVector<NodeId> > newId(n + 1);
+        newId[0].resize(2);
+        newId[0][0] = 0;
+        newId[0][1] = 1;
+
+        for (int i = 1; i <= n; ++i) {
+            size_t const m = table[i].size();
+            newId[i].resize(m);
+            for (size_t j = 0; j < m; ++j) {
+                NodeId const f0 = table[i][j].branch[0];
+                NodeId const f1 = table[i][j].branch[1];
+                newId[i][j] = getNode(i, newId[f0.row()][f0.col()],
+                                      newId[f1.row()][f1.col()]);
+            }
+        }
+
+        return newId[n][root.col()];
+    }
+
+    /**
+     * Writes a ZDD in the node store to a node table.
+     * Only the nodes reachable from the root are written.
+     * @param table the node table to be overwritten.
+     * @param f the root node in the node store.
+     * @return the root node in the table.
+     */
+    NodeId exportTo(NodeTableEntity<2>& table, NodeId f) const {
+        int const n = f.row();
+        table.init(n + 1);
+        if (n == 0) return f;
+
+        // (new column + 1) of each reachable node, or 0
+        MyVector<MyVector<size_t> > newCol(n + 1);
+        for (int i = 1; i <= n; ++i) {
+            newCol[i].resize(levels[i]->size());
+            std::fill(newCol[i].begin(), newCol[i].end(), 0);
+        }
+        newCol[n][f.col()] = 1;
+
+        for (int i = n; i >= 1; --i) {
+            Level const& level = *levels[i];
+            for (size_t j = 0; j < newCol[i].size(); ++j) {
+                if (newCol[i][j] == 0) continue;
+                for (int b = 0; b < 2; ++b) {
+                    NodeId const ff = level[j].branch[b];
+                    if (ff.row() > 0) newCol[ff.row()][ff.col()] = 1;
+                }
+            }
+        }
+
+        for (int i = 1; i <= n; ++i) {
+            Level const& level = *levels[i];
+            size_t m = 0;
+            for (size_t j = 0; j < newCol[i].size(); ++j) {
+                if (newCol[i][j] != 0) newCol[i][j] = ++m;
+            }
+
+            table.initRow(i, m);
+            for (size_t j = 0; j < newCol[i].size(); ++j) {
+                if (newCol[i][j] == 0) continue;
+                Node<2>& p = table[i][newCol[i][j] - 1];
+                for (int b = 0; b < 2; ++b) {
+                    NodeId const ff = level[j].branch[b];
+                    p.branch[b] = (ff.row() == 0) ? ff :
+                            NodeId(ff.row(), newCol[ff.row()][ff.col()] - 1,
+                                   ff.getAttr());
+                }
+            }
+        }
+
+        return NodeId(n, newCol[n][f.col()] - 1, f.getAttr());
+    }
+
+    /**
+     * Applies a binary operation.
+     * @param op the operation other than ONSET and OFFSET.
+     * @param f the first operand in the node store.
+     * @param g the second operand in the node store.
+     * @return the result in the node store.
+     */
+    NodeId apply(Operation op, NodeId f, NodeId g) {
+        assert(op != ONSET && op != OFFSET);
+        return apply_(op, f, g);
+    }
+
+    /**
+     * Selects the sets that have a variable.
+     * @param f the operand in the node store.
+     * @param level the level of the variable.
+     * @return the result in the node store.
+     */
+    NodeId onset(NodeId f, int level) {
+        return apply_(ONSET, f, NodeId(level));
+    }
+
+    /**
+     * Selects the sets that do not have a variable.
+     * @param f the operand in the node store.
+     * @param level the level of the variable.
+     * @return the result in the node store.
+     */
+    NodeId offset(NodeId f, int level) {
+        return apply_(OFFSET, f, NodeId(level));
+    }
+
+    /**
+     * Gets the name of an operation.
+     * @param op the operation.
+     * @return the name.
+     */
+    static char const* name(Operation op) {
+        static char const* const NAMES[] = { "union", "intersection",
+                "difference", "join", "meet", "restrict", "permit", "onset",
+                "offset" };
+        return NAMES[op];
+    }
+
+private:
+    NodeId apply_(Operation op, NodeId f, NodeId g) {
+        MessageHandler mh;
+        mh.begin(name(op)) << " <" << size() << "> ...";
+        prepareCaches();
+
+        NodeId r;
+#ifdef _OPENMP
+        if (threads >= 2) {
+#pragma omp parallel
+#pragma omp single
+            r = compute(op, f, g, 0);
+        }
+        else
+#endif
+        r = compute(op, f, g, taskDepth);
+
+        mh.end(size());
+        return r;
+    }
+
+    /*
+     * The entries are kept from the previous operations,
+     * since the nodes never change.
+     */
+    void prepareCaches() {
+        for (int y = 0; y < threads; ++y) {
+            if (caches[y].bits == 0) caches[y].resize(12);
+        }
+    }
+
+    Cache& cache() {
+#ifdef _OPENMP
+        return caches[(threads >= 2) ? omp_get_thread_num() : 0];
+#else
+        return caches[0];
+#endif
+    }
+
+    CacheEntry* cacheLookup(int op, NodeId f, NodeId g) {
+        CacheEntry& e = cache().at(op, f.code(), g.code());
+        return (e.op == op && e.f == f.code() && e.g == g.code()) ? &e : 0;
+    }
+
+    void cacheStore(int op, NodeId f, NodeId g, NodeId r) {
+        Cache& c = cache();
+        if (c.bits < CACHE_BITS && (c.stores >> c.bits) > 0) {
+            c.resize(c.bits + 1);
+        }
+        ++c.stores;
+        CacheEntry& e = c.at(op, f.code(), g.code());
+        e.f = f.code();
+        e.g = g.code();
+        e.r = r;
+        e.op = op;
+    }
+
+    NodeId getNode(int i, NodeId f0, NodeId f1) {
+        if (f1 == 0) return f0;
+        size_t j = levels[i]->add(Node<2>(f0, f1), threads >= 2);
+        return NodeId(i, j, f0.hasEmpty());
+    }
+
+    void cofactors(NodeId f, int i, NodeId& f0, NodeId& f1) const {
+        if (f.row() == i) {
+            Node<2> const& p = (*levels[i])[f.col()];
+            f0 = p.branch[0];
+            f1 = p.branch[1];
+        }
+        else {
+            f0 = f;
+            f1 = 0;
+        }
+    }
+
+    /**
+     * Checks the terminal cases.
+     * @return true if @p r is set to the result.
+     */
+    bool terminalCase(int op, NodeId f, NodeId g, NodeId& r) {
+        switch (op) {
+        case UNION:
+            if (f == 0 || f == g) r = g;
+            else if (g == 0) r = f;
+            else return false;
+            return true;
+        case INTERSECTION:
+            if (f == 0 || g == 0) r = 0;
+            else if (f == g) r = f;
+            else if (f == 1) r = g.hasEmpty() ? 1 : 0;
+            else if (g == 1) r = f.hasEmpty() ? 1 : 0;
+            else return false;
+            return true;
+        case DIFFERENCE:
+            if (f == 0 || f == g) r = 0;
+            else if (g == 0) r = f;
+            else if (f == 1) r = g.hasEmpty() ? 0 : 1;
+            else return false;
+            return true;
+        case JOIN:
+            if (f == 0 || g == 0) r = 0;
+            else if (f == 1) r = g;
+            else if (g == 1) r = f;
+            else return false;
+            return true;
+        case MEET:
+            if (f == 0 || g == 0) r = 0;
+            else if (f == 1 || g == 1) r = 1;
+            else return false;
+            return true;
+        case RESTRICT:
+            if (f == 0 || g == 0) r = 0;
+            else if (f == g || g.hasEmpty()) r = f;
+            else if (f == 1) r = 0;
+            else return false;
+            return true;
+        case PERMIT:
+            if (f == 0 || g == 0) r = 0;
+            else if (f == g || f == 1) r = f;
+            else if (g == 1) r = f.hasEmpty() ? 1 : 0;
+            else return false;
+            return true;
+        case ONSET:
+            if (f.row() == 0 || f.row() < int(g.code())) r = 0;
+            else if (f.row() == int(g.code())) {
+                r = getNode(f.row(), 0, (*levels[f.row()])[f.col()].branch[1]);
+            }
+            else return false;
+            return true;
+        case OFFSET:
+            if (f.row() == 0 || f.row() < int(g.code())) r = f;
+            else if (f.row() == int(g.code())) {
+                r = (*levels[f.row()])[f.col()].branch[0];
+            }
+            else return false;
+            return true;
+        }
+        assert(false);
+        return false;
+    }
+
+    NodeId compute(int op, NodeId f, NodeId g, int depth) {
+        NodeId r;
+        if (terminalCase(op, f, g, r)) return r;
+        if (op <= MEET && op != DIFFERENCE && f.code() < g.code()) {
+            std::swap(f, g); // commutative
+        }
+
+        CacheEntry const* e = cacheLookup(op, f, g);
+        if (e != 0) return e->r;
+
+        int const i = (op == ONSET || op == OFFSET) ?
+                f.row() : std::max(f.row(), g.row());
+        NodeId f0, f1, g0, g1;
+        cofactors(f, i, f0, f1);
+        if (op == ONSET || op == OFFSET) {
+            g0 = g1 = g; // the level
+        }
+        else {
+            cofactors(g, i, g0, g1);
+        }
+
+        NodeId r0, r1;
+#ifdef _OPENMP
+        if (depth < taskDepth) {
+#pragma omp task shared(r0)
+            r0 = compute0(op, f0, f1, g0, g1, depth + 1);
+            r1 = compute1(op, f0, f1, g0, g1, depth + 1);
+#pragma omp taskwait
+        }
+        else
+#endif
+        {
+            r0 = compute0(op, f0, f1, g0, g1, depth + 1);
+            r1 = compute1(op, f0, f1, g0, g1, depth + 1);
+        }
+        r = getNode(i, r0, r1);
+
+        cacheStore(op, f, g, r);
+        return r;
+    }
+
+    /// Computes the 0-child of the result.
+    NodeId compute0(int op, NodeId f0, NodeId f1, NodeId g0, NodeId g1,
+                    int depth) {
+        switch (op) {
+        case MEET:
+            return compute(UNION, compute(MEET, f0, g0, depth),
+                           compute(UNION, compute(MEET, f0, g1, depth),
+                                   compute(MEET, f1, g0, depth), depth),
+                           depth);
+        case PERMIT:
+            return compute(PERMIT, f0, compute(UNION, g0, g1, depth), depth);
+        default:
+            return compute(op, f0, g0, depth);
+        }
+    }
+
+    /// Computes the 1-child of the result.
+    NodeId compute1(int op, NodeId f0, NodeId f1, NodeId g0, NodeId g1,
+                    int depth) {
+        switch (op) {
+        case JOIN:
+            return compute(UNION, compute(JOIN, f1, g1, depth),
+                           compute(UNION, compute(JOIN, f1, g0, depth),
+                                   compute(JOIN, f0, g1, depth), depth),
+                           depth);
+        case RESTRICT:
+            return compute(RESTRICT, f1, compute(UNION, g0, g1, depth), depth);
+        default:
+            return compute(op, f1, g1, depth);
+        }
+    }
+};
+
+} // namespace tdzdd
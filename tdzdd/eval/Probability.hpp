@@ -0,0 +1,91 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include "../DdEval.hpp"
+#include "../util/MessageHandler.hpp"
+
+namespace tdzdd {
+
+/**
+ * ZDD evaluator that computes the probability of the family of sets
+ * when every item is chosen independently with a given probability,
+ * i.e., the sum of prod_{e in S} p_e prod_{e not in S} (1 - p_e)
+ * over all sets S in the family.
+ * @tparam T data type of probabilities,
+ *          which can be real or ModularNumber.
+ */
+template<typename T = double>
+class ZddProbability: public DdEval<ZddProbability<T>,T> {
+    std::vector<T> prob; ///< Probability of the item at each level.
+    std::vector<T> comp; ///< Complement of prob.
+    int topLevel;
+
+    T skip(T v, int from, int to) const {
+        for (int i = from + 1; i < to; ++i) {
+            v *= comp[i];
+        }
+        return v;
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param prob probabilities of items indexed by their levels,
+     *          where prob[0] is not used.
+     */
+    ZddProbability(std::vector<T> const& prob) :
+            prob(prob), comp(prob.size()), topLevel(0) {
+        for (size_t i = 0; i < prob.size(); ++i) {
+            comp[i] = T(1) - prob[i];
+        }
+    }
+
+    void initialize(int level) {
+        if (size_t(level) >= prob.size()) throw std::runtime_error(
+                "ZddProbability: no probability for level "
+                        + to_string(level));
+        topLevel = level;
+    }
+
+    void evalTerminal(T& v, int id) const {
+        v = T(id ? 1 : 0);
+    }
+
+    void evalNode(T& v, int i, DdValues<T,2> const& values) const {
+        v = skip(values.get(0), values.getLevel(0), i) * comp[i]
+                + skip(values.get(1), values.getLevel(1), i) * prob[i];
+    }
+
+    T getValue(T const& v) {
+        return skip(v, topLevel, prob.size());
+    }
+};
+
+} // namespace tdzdd
@@ -0,0 +1,200 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "../DdEval.hpp"
+#include "../util/BigNumber.hpp"
+#include "../util/MemoryPool.hpp"
+#include "../util/MyVector.hpp"
+
+namespace tdzdd {
+
+/**
+ * Work area of SizeDistributionBase for each node.
+ * The coefficient of x^k is stored in @p coef[k]
+ * and the polynomial of the 0-terminal has no coefficients.
+ * @tparam T data type of the coefficients.
+ */
+template<typename T>
+struct SizeDistributionWork {
+    T* coef;
+    int size;
+
+    SizeDistributionWork() :
+            coef(0),
+            size(0) {
+    }
+};
+
+template<typename E, typename T, int ARITY>
+class SizeDistributionBase: public DdEval<E,SizeDistributionWork<T>,
+        std::vector<T> > {
+    typedef SizeDistributionWork<T> Work;
+
+    int maxSize;
+    MemoryPools pools;
+
+public:
+    SizeDistributionBase(int maxSize = -1) :
+            maxSize(maxSize) {
+    }
+
+    void initialize(int level) {
+        pools.resize(level + 1);
+    }
+
+    void evalTerminal(Work& n, int id) {
+        n.size = id ? 1 : 0;
+        n.coef = pools[0].template allocate<T>(n.size);
+        if (id) n.coef[0] = 1;
+    }
+
+    void evalNode(Work& n, int i, DdValues<Work,ARITY> const& values) {
+        int w = values.get(0).size;
+        for (int b = 1; b < ARITY; ++b) {
+            int const s = values.get(b).size;
+            if (s > 0 && w < s + 1) w = s + 1;
+        }
+        if (maxSize >= 0 && w > maxSize + 1) w = maxSize + 1;
+
+        n.size = w;
+        n.coef = pools[i].template allocate<T>(w);
+
+        Work const& v0 = values.get(0);
+        for (int k = 0; k < w; ++k) {
+            n.coef[k] = (k < v0.size) ? v0.coef[k] : 0;
+        }
+        for (int b = 1; b < ARITY; ++b) {
+            Work const& v = values.get(b);
+            int const s = std::min(v.size, w - 1);
+            for (int k = 0; k < s; ++k) {
+                n.coef[k + 1] += v.coef[k];
+            }
+        }
+    }
+
+    std::vector<T> getValue(Work const& n) {
+        return std::vector<T>(n.coef, n.coef + n.size);
+    }
+
+    void destructLevel(int i) {
+        pools[i].clear();
+    }
+};
+
+template<typename E, int ARITY>
+class SizeDistributionBase<E,std::string,ARITY> : public DdEval<E,
+        SizeDistributionWork<BigNumber>,std::vector<std::string> > {
+    typedef SizeDistributionWork<BigNumber> Work;
+
+    int maxSize;
+    MemoryPools pools;
+    BigNumber tmp;
+
+public:
+    SizeDistributionBase(int maxSize = -1) :
+            maxSize(maxSize) {
+    }
+
+    void initialize(int level) {
+        pools.resize(level + 1);
+
+        int max = ceil(double(level) * log2(double(ARITY)) / 63.0) + 1;
+        tmp.setArray(pools[level].template allocate<uint64_t>(max));
+    }
+
+    void evalTerminal(Work& n, int id) {
+        n.size = id ? 1 : 0;
+        n.coef = pools[0].template allocate<BigNumber>(n.size);
+        if (id) {
+            n.coef[0].setArray(pools[0].template allocate<uint64_t>(1));
+            n.coef[0].store(1);
+        }
+    }
+
+    void evalNode(Work& n, int i, DdValues<Work,ARITY> const& values) {
+        int w = values.get(0).size;
+        for (int b = 1; b < ARITY; ++b) {
+            int const s = values.get(b).size;
+            if (s > 0 && w < s + 1) w = s + 1;
+        }
+        if (maxSize >= 0 && w > maxSize + 1) w = maxSize + 1;
+
+        n.size = w;
+        n.coef = pools[i].template allocate<BigNumber>(w);
+
+        Work const& v0 = values.get(0);
+        for (int k = 0; k < w; ++k) {
+            size_t ww = tmp.store((k < v0.size) ? v0.coef[k] : BigNumber());
+            for (int b = 1; b < ARITY; ++b) {
+                Work const& v = values.get(b);
+                if (0 < k && k - 1 < v.size) ww = tmp.add(v.coef[k - 1]);
+            }
+            n.coef[k].setArray(pools[i].template allocate<uint64_t>(ww));
+            n.coef[k].store(tmp);
+        }
+    }
+
+    std::vector<std::string> getValue(Work const& n) {
+        std::vector<std::string> v(n.size);
+        for (int k = 0; k < n.size; ++k) {
+            v[k] = n.coef[k];
+        }
+        return v;
+    }
+
+    void destructLevel(int i) {
+        pools[i].clear();
+    }
+};
+
+/**
+ * ZDD evaluator that counts the number of elements of each size.
+ * The k-th element of the result is the number of itemsets of size k,
+ * where an item is counted for every non-zero branch taken on the path.
+ * @tparam T data type for counting the number,
+ *          which can be integral, real, or std::string.
+ * @tparam AR arity of the nodes.
+ */
+template<typename T = std::string, int AR = 2>
+struct ZddSizeDistribution: public SizeDistributionBase<
+        ZddSizeDistribution<T,AR>,T,AR> {
+    /**
+     * Constructor.
+     * @param maxSize the maximum itemset size to be counted;
+     *          larger itemsets are ignored if it is not negative.
+     */
+    ZddSizeDistribution(int maxSize = -1) :
+            SizeDistributionBase<ZddSizeDistribution<T,AR>,T,AR>(maxSize) {
+    }
+};
+
+} // namespace tdzdd
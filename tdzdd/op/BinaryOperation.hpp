@@ -28,6 +28,7 @@
 #include <iostream>
 
 #include "../DdSpec.hpp"
+#include "ProductOperation.hpp"
 
 namespace tdzdd {
 
@@ -134,34 +135,9 @@ public:
     }
 };
 
-#if __cplusplus >= 201103L
-template<typename ... SS> struct BddAnd;
-
-template<typename S, typename S1, typename ... SS>
-struct BddAnd_: public BddAnd_<S,S1,BddAnd<SS...>> {
-    typedef BddAnd_<S,S1,BddAnd<SS...>> base;
-    typedef typename base::Word Word;
-
-    BddAnd_(S1 const& s1, SS const&... ss) :
-            base(s1, BddAnd<SS...>(ss...)) {
-    }
-
-    void print_state(std::ostream& os, void const* p, int level) const {
-        Word const* q = static_cast<Word const*>(p);
-        os << "<" << base::level1(q) << ",";
-        base::spec1.print_state(os, base::state1(q), level);
-        os << ">∧";
-        base::spec2.print_state(os, base::state2(q), level);
-    }
-};
-#endif
-
+#if __cplusplus < 201103L
 template<typename S, typename S1, typename S2>
-struct BddAnd_
-#if __cplusplus >= 201103L
-<S,S1,S2>
-#endif
-        : public BinaryOperation<S,S1,S2> {
+struct BddAnd_: public BinaryOperation<S,S1,S2> {
     typedef BinaryOperation<S,S1,S2> base;
     typedef typename base::Word Word;
 
@@ -203,6 +179,7 @@ struct BddAnd_
         os << ">";
     }
 };
+#endif
 
 #if __cplusplus >= 201103L
 template<typename ... SS> struct BddOr;
@@ -277,34 +254,9 @@ struct BddOr_
     }
 };
 
-#if __cplusplus >= 201103L
-template<typename ... SS> struct ZddIntersection;
-
-template<typename S, typename S1, typename ... SS>
-struct ZddIntersection_: public ZddIntersection_<S,S1,ZddIntersection<SS...>> {
-    typedef ZddIntersection_<S,S1,ZddIntersection<SS...>> base;
-    typedef typename base::Word Word;
-
-    ZddIntersection_(S1 const& s1, SS const&... ss) :
-            base(s1, ZddIntersection<SS...>(ss...)) {
-    }
-
-    void print_state(std::ostream& os, void const* p, int level) const {
-        Word const* q = static_cast<Word const*>(p);
-        os << "<" << base::level1(q) << ",";
-        base::spec1.print_state(os, base::state1(q), level);
-        os << ">∩";
-        base::spec2.print_state(os, base::state2(q), level);
-    }
-};
-#endif
-
+#if __cplusplus < 201103L
 template<typename S, typename S1, typename S2>
-struct ZddIntersection_
-#if __cplusplus >= 201103L
-<S,S1,S2>
-#endif
-        : public PodArrayDdSpec<S,size_t,2> {
+struct ZddIntersection_: public PodArrayDdSpec<S,size_t,2> {
     typedef S1 Spec1;
     typedef S2 Spec2;
     typedef size_t Word;
@@ -422,6 +374,7 @@ public:
         os << ">";
     }
 };
+#endif
 
 #if __cplusplus >= 201103L
 template<typename ... SS> struct ZddUnion;
@@ -503,13 +456,6 @@ struct ZddUnion_
 };
 
 #if __cplusplus >= 201103L
-template<typename ... SS>
-struct BddAnd: public BddAnd_<BddAnd<SS...>,SS...> {
-    BddAnd(SS const&... ss) :
-            BddAnd_<BddAnd,SS...>(ss...) {
-    }
-};
-
 template<typename ... SS>
 struct BddOr: public BddOr_<BddOr<SS...>,SS...> {
     BddOr(SS const&... ss) :
@@ -517,13 +463,6 @@ struct BddOr: public BddOr_<BddOr<SS...>,SS...> {
     }
 };
 
-template<typename ... SS>
-struct ZddIntersection: public ZddIntersection_<ZddIntersection<SS...>,SS...> {
-    ZddIntersection(SS const&... ss) :
-            ZddIntersection_<ZddIntersection,SS...>(ss...) {
-    }
-};
-
 template<typename ... SS>
 struct ZddUnion: public ZddUnion_<ZddUnion<SS...>,SS...> {
     ZddUnion(SS const&... ss) :
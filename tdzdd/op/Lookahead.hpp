@@ -85,6 +85,10 @@ public:
         return lookahead(p, spec.get_child(p, level, b));
     }
 
+    bool is_forced_zero(void const* p, int level) const {
+        return spec.is_forced_zero(p, level);
+    }
+
     void get_copy(void* to, void const* from) {
         spec.get_copy(to, from);
     }
@@ -128,6 +132,11 @@ class ZddLookahead: public DdSpecBase<ZddLookahead<S>,S::ARITY> {
     int lookahead(void* p, int level) {
         void* const q = work.data();
         while (level >= 1) {
+            if (spec.is_forced_zero(p, level)) {
+                level = spec.get_child(p, level, 0);
+                continue;
+            }
+
             for (int b = 1; b < Spec::ARITY; ++b) {
                 spec.get_copy(q, p);
                 if (spec.get_child(q, level, b) != 0) {
@@ -159,6 +168,93 @@ public:
         return lookahead(p, spec.get_child(p, level, b));
     }
 
+    bool is_forced_zero(void const* p, int level) const {
+        return spec.is_forced_zero(p, level);
+    }
+
+    void get_copy(void* to, void const* from) {
+        spec.get_copy(to, from);
+    }
+
+    int merge_states(void* p1, void* p2) {
+        return spec.merge_states(p1, p2);
+    }
+
+    void destruct(void* p) {
+        spec.destruct(p);
+    }
+
+    void destructLevel(int level) {
+        spec.destructLevel(level);
+    }
+
+    size_t hash_code(void const* p, int level) const {
+        return spec.hash_code(p, level);
+    }
+
+    bool equal_to(void const* p, void const* q, int level) const {
+        return spec.equal_to(p, q, level);
+    }
+
+    void print_state(std::ostream& os, void const* p, int level) const {
+        spec.print_state(os, p, level);
+    }
+
+    void print_level(std::ostream& os, int level) const {
+        spec.print_level(os, level);
+    }
+};
+
+/**
+ * ZDD specification that skips the levels where the specification
+ * reports that only the 0-branch can lead to the 1-terminal,
+ * as ZddLookahead does, but relies only on is_forced_zero(void const*, int)
+ * of the specification.
+ * The skipped levels are applied to the state in place, so that
+ * no intermediate state is copied or stored.
+ */
+template<typename S>
+class ZddSkipForced: public DdSpecBase<ZddSkipForced<S>,S::ARITY> {
+    typedef S Spec;
+
+    Spec spec;
+    bool enabled;
+
+    int skip(void* p, int level) {
+        while (enabled && level >= 1 && spec.is_forced_zero(p, level)) {
+            level = spec.get_child(p, level, 0);
+        }
+        return level;
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param s the specification.
+     * @param enabled false to pass the specification through, so that
+     *        a program can choose at run time without building with
+     *        two types of specifications.
+     */
+    ZddSkipForced(S const& s, bool enabled = true)
+            : spec(s), enabled(enabled) {
+    }
+
+    int datasize() const {
+        return spec.datasize();
+    }
+
+    int get_root(void* p) {
+        return skip(p, spec.get_root(p));
+    }
+
+    int get_child(void* p, int level, int b) {
+        return skip(p, spec.get_child(p, level, b));
+    }
+
+    bool is_forced_zero(void const* p, int level) const {
+        return spec.is_forced_zero(p, level);
+    }
+
     void get_copy(void* to, void const* from) {
         spec.get_copy(to, from);
     }
@@ -0,0 +1,413 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#if __cplusplus >= 201103L
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <tuple>
+#include <type_traits>
+
+#include "../DdSpec.hpp"
+
+namespace tdzdd {
+
+/**
+ * Base of the specifications for an operation on N specifications.
+ * The states of all the specifications are laid out one after another in
+ * a flat array, optionally after the current levels of the specifications,
+ * so that the operation copies, hashes and compares them in one pass
+ * instead of descending through a chain of nested binary operations.
+ * (since C++11)
+ * @tparam S the class implementing this class.
+ * @tparam LEVELS whether the array stores the level of each specification.
+ * @tparam SS the specifications.
+ */
+template<typename S, bool LEVELS, typename ... SS>
+class ProductOperation: public PodArrayDdSpec<S,size_t,2> {
+protected:
+    typedef size_t Word;
+    static size_t const N = sizeof...(SS);
+
+    template<size_t K>
+    struct Index: std::integral_constant<size_t,K> {
+    };
+
+    typedef Index<N> End;
+
+    static size_t const levelWords =
+            LEVELS ? (N * sizeof(int) + sizeof(Word) - 1) / sizeof(Word) : 0;
+
+    std::tuple<SS...> specs;
+    int offset[N + 1]; ///< the word offset of each state in the array.
+
+    static int wordSize(int size) {
+        return (size + sizeof(Word) - 1) / sizeof(Word);
+    }
+
+    template<size_t K>
+    typename std::tuple_element<K,std::tuple<SS...>>::type& spec() {
+        return std::get<K>(specs);
+    }
+
+    template<size_t K>
+    typename std::tuple_element<K,std::tuple<SS...>>::type const& spec() const {
+        return std::get<K>(specs);
+    }
+
+    static void setLevel(void* p, size_t k, int level) {
+        static_cast<int*>(p)[k] = level;
+    }
+
+    static int level(void const* p, size_t k) {
+        return static_cast<int const*>(p)[k];
+    }
+
+    void* state(void* p, size_t k) const {
+        return static_cast<Word*>(p) + levelWords + offset[k];
+    }
+
+    void const* state(void const* p, size_t k) const {
+        return static_cast<Word const*>(p) + levelWords + offset[k];
+    }
+
+    /**
+     * Gets the root of each specification.
+     * @param p the array.
+     * @param lv the array to store the levels of the roots.
+     * @return false if a root is the 0-terminal.
+     */
+    template<size_t K>
+    bool getRoots(void* p, int* lv, Index<K>) {
+        lv[K] = spec<K>().get_root(state(p, K));
+        if (lv[K] == 0) return false;
+        return getRoots(p, lv, Index<K + 1>());
+    }
+
+    bool getRoots(void*, int*, End) {
+        return true;
+    }
+
+    /**
+     * Gets the child of each specification.
+     * @param p the array.
+     * @param lv the levels of the specifications, which are updated.
+     * @param level the level of the node.
+     * @param take the branch.
+     * @param all whether to advance also the specifications below the level.
+     * @return false if a child is the 0-terminal.
+     */
+    template<size_t K>
+    bool getChildren(void* p, int* lv, int level, int take, bool all,
+                     Index<K>) {
+        if (all || lv[K] == level) {
+            lv[K] = spec<K>().get_child(state(p, K), level, take);
+            if (lv[K] == 0) return false;
+        }
+        return getChildren(p, lv, level, take, all, Index<K + 1>());
+    }
+
+    bool getChildren(void*, int*, int, int, bool, End) {
+        return true;
+    }
+
+    /**
+     * Takes the 0-branches of the specifications above a level.
+     * @param p the array.
+     * @param lv the levels of the specifications, which are updated.
+     * @param level the level.
+     * @return false if a child is the 0-terminal.
+     */
+    template<size_t K>
+    bool skipDown(void* p, int* lv, int level, Index<K>) {
+        while (lv[K] > level) {
+            lv[K] = spec<K>().get_child(state(p, K), lv[K], 0);
+            if (lv[K] == 0) return false;
+        }
+        return skipDown(p, lv, level, Index<K + 1>());
+    }
+
+    bool skipDown(void*, int*, int, End) {
+        return true;
+    }
+
+    template<size_t K>
+    bool anyForcedZero(void const* p, int level, Index<K>) const {
+        return spec<K>().is_forced_zero(state(p, K), level)
+                || anyForcedZero(p, level, Index<K + 1>());
+    }
+
+    bool anyForcedZero(void const*, int, End) const {
+        return false;
+    }
+
+    template<size_t K>
+    void getCopies(void* to, void const* from, Index<K>) {
+        spec<K>().get_copy(state(to, K), state(from, K));
+        getCopies(to, from, Index<K + 1>());
+    }
+
+    void getCopies(void*, void const*, End) {
+    }
+
+    template<size_t K>
+    int mergeAll(void* p1, void* p2, Index<K>) {
+        return spec<K>().merge_states(state(p1, K), state(p2, K))
+                | mergeAll(p1, p2, Index<K + 1>());
+    }
+
+    int mergeAll(void*, void*, End) {
+        return 0;
+    }
+
+    template<size_t K>
+    void destructAll(void* p, Index<K>) {
+        spec<K>().destruct(state(p, K));
+        destructAll(p, Index<K + 1>());
+    }
+
+    void destructAll(void*, End) {
+    }
+
+    template<size_t K>
+    void destructLevelAll(int level, Index<K>) {
+        spec<K>().destructLevel(level);
+        destructLevelAll(level, Index<K + 1>());
+    }
+
+    void destructLevelAll(int, End) {
+    }
+
+    int levelOf(void const* p, size_t k, int level) const {
+        return LEVELS ? this->level(p, k) : level;
+    }
+
+    template<size_t K>
+    size_t hashAll(void const* p, int level, Index<K>) const {
+        static size_t const PRIMES[] = {314159257, 271828171, 171828143,
+                                        141421333, 173205083, 223606799};
+        size_t const prime = PRIMES[K % 6] + 2 * (K / 6);
+        int const lv = levelOf(p, K, level);
+        size_t h = LEVELS ? size_t(lv) * prime : 0;
+        if (lv > 0) h += spec<K>().hash_code(state(p, K), lv);
+        return h * prime + hashAll(p, level, Index<K + 1>());
+    }
+
+    size_t hashAll(void const*, int, End) const {
+        return 0;
+    }
+
+    template<size_t K>
+    bool equalAll(void const* p, void const* q, int level, Index<K>) const {
+        int const lv = levelOf(p, K, level);
+        if (LEVELS && lv != this->level(q, K)) return false;
+        if (lv > 0 && !spec<K>().equal_to(state(p, K), state(q, K), lv))
+            return false;
+        return equalAll(p, q, level, Index<K + 1>());
+    }
+
+    bool equalAll(void const*, void const*, int, End) const {
+        return true;
+    }
+
+    template<size_t K>
+    void printAll(std::ostream& os, void const* p, int level, char const* op,
+                  Index<K>) const {
+        if (K > 0) os << op;
+        os << "<";
+        if (LEVELS) os << this->level(p, K) << ",";
+        spec<K>().print_state(os, state(p, K), level);
+        os << ">";
+        printAll(os, p, level, op, Index<K + 1>());
+    }
+
+    void printAll(std::ostream&, void const*, int, char const*, End) const {
+    }
+
+    template<size_t K>
+    void setOffsets(Index<K>) {
+        offset[K + 1] = offset[K] + wordSize(spec<K>().datasize());
+        setOffsets(Index<K + 1>());
+    }
+
+    void setOffsets(End) {
+    }
+
+public:
+    ProductOperation(SS const&... ss) :
+            specs(ss...) {
+        offset[0] = 0;
+        setOffsets(Index<0>());
+        ProductOperation::setArraySize(levelWords + offset[N]);
+    }
+
+    void get_copy(void* to, void const* from) {
+        if (LEVELS) {
+            for (size_t k = 0; k < N; ++k) {
+                setLevel(to, k, level(from, k));
+            }
+        }
+        getCopies(to, from, Index<0>());
+    }
+
+    int merge_states(void* p1, void* p2) {
+        return mergeAll(p1, p2, Index<0>());
+    }
+
+    void destruct(void* p) {
+        destructAll(p, Index<0>());
+    }
+
+    void destructLevel(int level) {
+        destructLevelAll(level, Index<0>());
+    }
+
+    size_t hash_code(void const* p, int level) const {
+        return hashAll(p, level, Index<0>());
+    }
+
+    bool equal_to(void const* p, void const* q, int level) const {
+        return equalAll(p, q, level, Index<0>());
+    }
+};
+
+/**
+ * BDD specification for logical AND of specifications.
+ * Each specification keeps its own level, since a skipped level of a BDD
+ * means that the variable does not matter.
+ * (since C++11)
+ */
+template<typename ... SS>
+struct BddAnd: public ProductOperation<BddAnd<SS...>,true,SS...> {
+    typedef ProductOperation<BddAnd,true,SS...> base;
+    typedef typename base::Word Word;
+
+    BddAnd(SS const&... ss) :
+            base(ss...) {
+    }
+
+    int getRoot(Word* p) {
+        int lv[base::N];
+        if (!base::getRoots(p, lv, typename base::template Index<0>())) {
+            return 0;
+        }
+        int i = -1;
+        for (size_t k = 0; k < base::N; ++k) {
+            base::setLevel(p, k, lv[k]);
+            i = std::max(i, lv[k]);
+        }
+        return i;
+    }
+
+    int getChild(Word* p, int level, int take) {
+        int lv[base::N];
+        for (size_t k = 0; k < base::N; ++k) {
+            lv[k] = base::level(p, k);
+            assert(lv[k] <= level);
+        }
+        if (!base::getChildren(p, lv, level, take, false,
+                typename base::template Index<0>())) {
+            return 0;
+        }
+        int i = -1;
+        for (size_t k = 0; k < base::N; ++k) {
+            base::setLevel(p, k, lv[k]);
+            i = std::max(i, lv[k]);
+        }
+        return i;
+    }
+
+    void print_state(std::ostream& os, void const* p, int level) const {
+        base::printAll(os, p, level, "∧", typename base::template Index<0>());
+    }
+};
+
+/**
+ * ZDD specification for set intersection of specifications.
+ * All the specifications are kept at the same level, since a skipped
+ * level of a ZDD means that the item is not taken.
+ * (since C++11)
+ */
+template<typename ... SS>
+struct ZddIntersection: public ProductOperation<ZddIntersection<SS...>,false,
+        SS...> {
+    typedef ProductOperation<ZddIntersection,false,SS...> base;
+    typedef typename base::Word Word;
+
+    ZddIntersection(SS const&... ss) :
+            base(ss...) {
+    }
+
+    int getRoot(Word* p) {
+        int lv[base::N];
+        if (!base::getRoots(p, lv, typename base::template Index<0>())) {
+            return 0;
+        }
+        return align(p, lv);
+    }
+
+    int getChild(Word* p, int level, int take) {
+        int lv[base::N];
+        if (!base::getChildren(p, lv, level, take, true,
+                typename base::template Index<0>())) {
+            return 0;
+        }
+        return align(p, lv);
+    }
+
+    bool is_forced_zero(void const* p, int level) const {
+        return base::anyForcedZero(p, level,
+                typename base::template Index<0>());
+    }
+
+    void print_state(std::ostream& os, void const* p, int level) const {
+        base::printAll(os, p, level, "∩", typename base::template Index<0>());
+    }
+
+private:
+    /**
+     * Takes the 0-branches until all the specifications reach the same level.
+     * @param p the array.
+     * @param lv the levels of the specifications.
+     * @return the common level.
+     */
+    int align(Word* p, int* lv) {
+        for (;;) {
+            int i = *std::min_element(lv, lv + base::N);
+            if (*std::max_element(lv, lv + base::N) == i) return i;
+            if (!base::skipDown(p, lv, i, typename base::template Index<0>())) {
+                return 0;
+            }
+        }
+    }
+};
+
+} // namespace tdzdd
+
+#endif
@@ -164,6 +164,105 @@ public:
         return p - array;
     }
 
+    /**
+     * Subtracts another number that is not greater than this number.
+     * @param o the number to be subtracted.
+     * @return the number of words used.
+     */
+    size_t subtract(BigNumber const& o) {
+        int const n = size();
+        int const m = o.effectiveSize();
+        if (array == 0 || n < m) throw std::runtime_error(
+                "BigNumber subtraction underflow");
+
+        uint64_t borrow = 0;
+        for (int i = 0; i < n; ++i) {
+            uint64_t x = array[i] & ~MSB;
+            uint64_t y = ((i < m) ? o.array[i] & ~MSB : 0) + borrow;
+            if (x >= y) {
+                array[i] = x - y;
+                borrow = 0;
+            }
+            else {
+                array[i] = (MSB - y) + x;
+                borrow = 1;
+            }
+        }
+        if (borrow) throw std::runtime_error("BigNumber subtraction underflow");
+
+        int k = n;
+        while (k > 1 && array[k - 1] == 0) {
+            --k;
+        }
+        for (int i = 0; i < k - 1; ++i) {
+            array[i] |= MSB;
+        }
+        return k;
+    }
+
+    /**
+     * Multiplies this number by @p m and then adds @p a.
+     * @param m multiplier.
+     * @param a addend.
+     * @return the number of words used.
+     */
+    size_t multiplyAdd(uint32_t m, uint32_t a) {
+        uint64_t const MASK32 = (uint64_t(1) << 32) - 1;
+        uint64_t* p = array;
+        uint64_t c = a;
+
+        if (p == 0) {
+            if (a != 0) throw std::runtime_error(
+                    "Non-zero assignment to null BigNumber");
+            return 1;
+        }
+
+        while (true) {
+            bool cont = *p & MSB;
+            uint64_t x = (*p & MASK32) * m + c;
+            uint64_t h = ((*p & ~MSB) >> 32) * m + (x >> 32);
+            uint64_t v = ((h & ((uint64_t(1) << 31) - 1)) << 32) | (x & MASK32);
+            c = h >> 31;
+            if (cont) {
+                *p++ = v | MSB;
+            }
+            else if (c != 0) {
+                *p++ = v | MSB;
+                *p++ = c;
+                break;
+            }
+            else {
+                *p++ = v;
+                break;
+            }
+        }
+
+        return p - array;
+    }
+
+    /**
+     * Compares with another number.
+     * @param o the number to be compared.
+     * @return negative, zero, or positive value when this number is
+     *          less than, equal to, or greater than @p o respectively.
+     */
+    int compare(BigNumber const& o) const {
+        int const n = effectiveSize();
+        int const m = o.effectiveSize();
+        if (n != m) return (n < m) ? -1 : 1;
+
+        for (int i = n - 1; i >= 0; --i) {
+            uint64_t x = array[i] & ~MSB;
+            uint64_t y = o.array[i] & ~MSB;
+            if (x != y) return (x < y) ? -1 : 1;
+        }
+        return 0;
+    }
+
+    bool operator<(BigNumber const& o) const {
+        return compare(o) < 0;
+    }
+
     uint32_t divide(uint32_t n) {
         uint64_t* p = array;
         if (p == 0) return 0;
@@ -226,6 +325,7 @@ public:
 
     template<typename T>
     T translate() const {
+        if (array == 0) return 0;
         uint64_t const* p = array;
         while (*p & MSB) {
             ++p;
@@ -239,6 +339,15 @@ public:
     }
 
 private:
+    int effectiveSize() const {
+        if (array == 0) return 0;
+        int k = size();
+        while (k > 0 && (array[k - 1] & ~MSB) == 0) {
+            --k;
+        }
+        return k;
+    }
+
     void printHelper(std::ostream& os) {
         uint32_t r = divide(10);
         if (*this != 0) printHelper(os);
@@ -31,6 +31,7 @@
 #include <climits>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <set>
 #include <sstream>
@@ -38,6 +39,17 @@
 #include <stdint.h>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MessageHandler.hpp"
+#include "MyHashTable.hpp"
+#include "NameTable.hpp"
+
 namespace tdzdd {
 
 class Graph {
@@ -82,15 +94,17 @@ public:
     static ColorNumber const MAX_COLORS = USHRT_MAX;
 
 private:
-    std::vector<std::pair<std::string,std::string> > edgeNames;
+    typedef std::pair<int,int> NamePair; ///< Pair of numbers in names.
+
+    NameTable names;
+    std::vector<NamePair> edgeNames;
     std::map<std::string,std::string> name2label;
     std::map<std::string,std::string> name2color;
-    std::map<std::string,VertexNumber> name2vertex;
+    std::vector<VertexNumber> name2vertex;
     std::vector<std::string> vertex2name;
-    std::map<std::pair<std::string,std::string>,EdgeNumber> name2edge;
-    std::vector<std::pair<std::string,std::string> > edge2name;
+    std::vector<NamePair> edge2name;
     std::vector<EdgeInfo> edgeInfo_;
-    std::map<VertexNumberPair,EdgeNumber> edgeIndex;
+    MyHashMap<uint64_t,EdgeNumber> edgeIndex;
     std::vector<VertexNumber> virtualMate_;
     std::vector<ColorNumber> colorNumber_;
     VertexNumber vMax;
@@ -98,8 +112,13 @@ private:
     bool hasColorPairs_;
 
 public:
+    Graph()
+            : vMax(0), numColor_(0), hasColorPairs_(false) {
+    }
+
     void addEdge(std::string vertexName1, std::string vertexName2) {
-        edgeNames.push_back(std::make_pair(vertexName1, vertexName2));
+        edgeNames.push_back(
+                NamePair(names.intern(vertexName1), names.intern(vertexName2)));
     }
 
     void setColor(std::string v, std::string color) {
@@ -120,9 +139,38 @@ public:
         }
         else {
             mh << " \"" << filename << "\" ...";
+#ifndef _WIN32
+            int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error(strerror(errno));
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw std::runtime_error(strerror(errno));
+            }
+            size_t const size = st.st_size;
+            if (size > 0) {
+                void* p = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    close(fd);
+                    throw std::runtime_error(strerror(errno));
+                }
+                madvise(p, size, MADV_SEQUENTIAL);
+                try {
+                    readEdges(static_cast<char const*>(p), size);
+                }
+                catch (...) {
+                    munmap(p, size);
+                    close(fd);
+                    throw;
+                }
+                munmap(p, size);
+            }
+            close(fd);
+#else
             std::ifstream fin(filename.c_str(), std::ios::in);
             if (!fin) throw std::runtime_error(strerror(errno));
             readEdges(fin);
+#endif
         }
 
         mh.end();
@@ -169,50 +217,50 @@ public:
 
 private:
     void readEdges(std::istream& is) {
-        std::string v, v1, v2;
+        std::string buf((std::istreambuf_iterator<char>(is)),
+                std::istreambuf_iterator<char>());
+        readEdges(buf.data(), buf.size());
+    }
 
-        while (is) {
-            char c = is.get();
+    static bool isSpace(char c) {
+        return c == ' ' || ('\t' <= c && c <= '\r');
+    }
 
-            if (isspace(c)) {
-                if (!v.empty()) {
-                    if (v1.empty()) {
-                        v1 = v;
-                        v.clear();
-                    }
-                    else if (v2.empty()) {
-                        v2 = v;
-                        v.clear();
-                    }
-                    else {
-                        throw std::runtime_error(
-                                "ERROR: More than two tokens in a line");
-                    }
-                }
+    /*
+     * Reads lines of two vertex names each from memory.
+     * Names are interned directly from the buffer without copying.
+     */
+    void readEdges(char const* p, size_t size) {
+        char const* const end = p + size;
+        int v[2];
+        int n = 0;
 
-                if (c == '\n') {
-                    if (!v1.empty() && !v2.empty()) {
-                        edgeNames.push_back(std::make_pair(v1, v2));
-                        v1.clear();
-                        v2.clear();
-                    }
-                    else if (!v1.empty()) {
-                        throw std::runtime_error(
-                                "ERROR: Only one token in a line");
-                    }
+        while (true) {
+            if (p == end || *p == '\n') {
+                if (n == 2) {
+                    edgeNames.push_back(NamePair(v[0], v[1]));
                 }
+                else if (n == 1) {
+                    throw std::runtime_error("ERROR: Only one token in a line");
+                }
+                n = 0;
+                if (p == end) break;
+                ++p;
+            }
+            else if (isSpace(*p)) {
+                ++p;
             }
             else {
-                v += c;
+                char const* q = p;
+                while (q != end && !isSpace(*q)) {
+                    ++q;
+                }
+                if (n == 2) throw std::runtime_error(
+                        "ERROR: More than two tokens in a line");
+                v[n++] = names.intern(p, q - p);
+                p = q;
             }
         }
-
-        if (!v1.empty() && !v2.empty()) {
-            edgeNames.push_back(std::make_pair(v1, v2));
-        }
-        else if (!v1.empty()) {
-            throw std::runtime_error("ERROR: Only one token in a line");
-        }
     }
 
     void readAdjacencyList(std::istream& is) {
@@ -232,7 +280,9 @@ private:
             is.unget();
             is >> v2;
 
-            edgeNames.push_back(std::make_pair(to_string(v1), to_string(v2)));
+            edgeNames.push_back(
+                    NamePair(names.intern(to_string(v1)),
+                            names.intern(to_string(v2))));
         }
     }
 
@@ -280,41 +330,43 @@ public:
      *   name2color
      */
     void update() {
-        name2vertex.clear();
+        name2vertex.assign(names.size(), 0);
         vertex2name.clear();
-        name2edge.clear();
         edge2name.clear();
-        edgeInfo_.clear();
-        edgeIndex.clear();
-        vMax = 0;
 
         // Make unique edge name list
-        for (size_t i = 0; i < edgeNames.size(); ++i) {
-            std::pair<std::string,std::string> const& e = edgeNames[i];
+        {
+            MyHashMap<uint64_t,bool> uniq(edgeNames.size());
+
+            for (size_t i = 0; i < edgeNames.size(); ++i) {
+                NamePair const& e = edgeNames[i];
+                uint64_t k1 = std::min(e.first, e.second) + 1;
+                uint64_t k2 = std::max(e.first, e.second) + 1;
+                bool& found = uniq[(k1 << 32) | k2];
 
-            if (name2edge.count(e) == 0) {
-                edge2name.push_back(e);
-                name2edge[e] = -1;
-                name2edge[std::make_pair(e.second, e.first)] = -1;
+                if (!found) {
+                    found = true;
+                    edge2name.push_back(e);
+                }
             }
         }
 
         // Sort vertices by leaving order
         {
-            std::vector<std::string> stack;
+            std::vector<int> stack;
             stack.reserve(edge2name.size() * 2);
 
             for (size_t i = edge2name.size() - 1; i + 1 > 0; --i) {
-                std::string const& s1 = edge2name[i].first;
-                std::string const& s2 = edge2name[i].second;
+                int s1 = edge2name[i].first;
+                int s2 = edge2name[i].second;
 
-                if (name2vertex.count(s2) == 0) {
-                    name2vertex[s2] = 0;
+                if (name2vertex[s2] == 0) {
+                    name2vertex[s2] = -1;
                     stack.push_back(s2);
                 }
 
-                if (name2vertex.count(s1) == 0) {
-                    name2vertex[s1] = 0;
+                if (name2vertex[s1] == 0) {
+                    name2vertex[s1] = -1;
                     stack.push_back(s1);
                 }
             }
@@ -322,40 +374,85 @@ public:
             vertex2name.push_back(""); // begin vertex number with 1
 
             while (!stack.empty()) {
-                std::string const& s = stack.back();
+                int s = stack.back();
                 name2vertex[s] = vertex2name.size();
-                vertex2name.push_back(s);
+                vertex2name.push_back(names.name(s));
                 if (vertex2name.size() > size_t(MAX_VERTICES)) throw std::runtime_error(
                         "ERROR: Vertex number > " + to_string(MAX_VERTICES));
                 stack.pop_back();
             }
         }
 
-        for (size_t i = 0; i < edge2name.size(); ++i) {
-            std::pair<std::string,std::string> const& e = edge2name[i];
-            std::string s1 = e.first;
-            std::string s2 = e.second;
+        updateEdges();
+    }
 
-            if (name2vertex[s1] > name2vertex[s2]) {
-                std::swap(s1, s2);
+    /*
+     * Replaces the graph by one whose vertices are already numbered,
+     * skipping the renumbering done by update().
+     * The vertices must be numbered as update() does, in the order they
+     * leave the frontier: the index of the last edge incident to v must
+     * not decrease as v increases, and every vertex must have an edge.
+     * The frontier specs depend on this order, so it is checked.
+     * INPUT:
+     *   vertexNames: name of vertex v at number v - 1 (swapped out)
+     *   edges: vertex number pairs in processing order (swapped out)
+     *   name2color
+     */
+    void assignNumbered(NameTable& vertexNames,
+            std::vector<VertexNumberPair>& edges) {
+        std::vector<size_t> lastEdge(vertexNames.size() + 1, 0);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            VertexNumber v1 = edges[i].first;
+            VertexNumber v2 = edges[i].second;
+            if (v1 < 1 || vertexNames.size() < v1 || v2 < 1
+                    || vertexNames.size() < v2) throw std::runtime_error(
+                    "ERROR: (" + to_string(v1) + "," + to_string(v2)
+                            + "): Vertex number out of range");
+            lastEdge[v1] = lastEdge[v2] = i + 1;
+            edges[i] = NamePair(v1 - 1, v2 - 1);
+        }
+        for (int v = 1; v <= vertexNames.size(); ++v) {
+            if (lastEdge[v] == 0 || lastEdge[v] < lastEdge[v - 1]) {
+                throw std::runtime_error(
+                        "ERROR: Vertices are not numbered in leaving order");
             }
+        }
+
+        names.swap(vertexNames);
+        edgeNames.swap(edges);
+        edge2name = edgeNames;
+        name2vertex.resize(names.size());
+        vertex2name.resize(names.size() + 1);
+        for (int id = 0; id < names.size(); ++id) {
+            name2vertex[id] = id + 1;
+            vertex2name[id + 1] = names.name(id);
+        }
 
-            VertexNumber v1 = name2vertex[s1];
-            VertexNumber v2 = name2vertex[s2];
+        updateEdges();
+    }
+
+private:
+    /*
+     * INPUT:
+     *   name2vertex
+     *   edge2name
+     *   name2color
+     */
+    void updateEdges() {
+        edgeInfo_.clear();
+        edgeIndex.initialize(edge2name.size());
+        vMax = 0;
 
-            if (v1 == 0) throw std::runtime_error(
-                    "ERROR: " + s1 + ": No such vertex");
-            if (v2 == 0) throw std::runtime_error(
-                    "ERROR: " + s2 + ": No such vertex");
+        for (size_t i = 0; i < edge2name.size(); ++i) {
+            VertexNumber v1 = name2vertex[edge2name[i].first];
+            VertexNumber v2 = name2vertex[edge2name[i].second];
+            if (v1 > v2) std::swap(v1, v2);
 
-            VertexNumberPair vp(v1, v2);
+            EdgeNumber& a = edgeIndex[edgeKey(v1, v2)];
 
-            if (edgeIndex.count(vp) == 0) {
-                EdgeNumber a = edgeInfo_.size();
+            if (a == 0) {
+                a = edgeInfo_.size() + 1;
                 edgeInfo_.push_back(EdgeInfo(v1, v2));
-                edgeIndex[vp] = a;
-                name2edge[std::make_pair(s1, s2)] = a;
-                name2edge[std::make_pair(s2, s1)] = a;
                 if (vMax < v2) vMax = v2;
             }
 
@@ -368,7 +465,8 @@ public:
 
             for (std::map<std::string,std::string>::iterator t =
                     name2color.begin(); t != name2color.end(); ++t) {
-                VertexNumber v = name2vertex[t->first];
+                int id = names.find(t->first);
+                VertexNumber v = (id >= 0) ? name2vertex[id] : 0;
                 if (v == 0) throw std::runtime_error(
                         "ERROR: " + t->first + ": No such vertex");
                 color2vertices[t->second].insert(v); // color => set of vertices
@@ -483,6 +581,7 @@ public:
         }
     }
 
+public:
     VertexNumber vertexSize() const {
         return vMax;
     }
@@ -498,11 +597,11 @@ public:
     }
 
     VertexNumber getVertex(std::string const& name) const {
-        std::map<std::string,VertexNumber>::const_iterator found =
-                name2vertex.find(name);
-        if (found == name2vertex.end()) throw std::runtime_error(
-                "ERROR: " + name + ": No such vertex");
-        return found->second;
+        int id = names.find(name);
+        if (id < 0 || size_t(id) >= name2vertex.size() || name2vertex[id] <= 0) {
+            throw std::runtime_error("ERROR: " + name + ": No such vertex");
+        }
+        return name2vertex[id];
     }
 
     std::string vertexName(VertexNumber v) const {
@@ -510,6 +609,12 @@ public:
         return vertex2name[v];
     }
 
+    std::string vertexColor(VertexNumber v) const {
+        std::map<std::string,std::string>::const_iterator found =
+                name2color.find(vertexName(v));
+        return (found != name2color.end()) ? found->second : "";
+    }
+
     std::string vertexLabel(VertexNumber v) const {
         std::string label = vertexName(v);
 
@@ -523,11 +628,18 @@ public:
     }
 
     EdgeNumber getEdge(std::pair<std::string,std::string> const& name) const {
-        std::map<std::pair<std::string,std::string>,EdgeNumber>::const_iterator found =
-                name2edge.find(name);
-        if (found == name2edge.end()) throw std::runtime_error(
+        int id1 = names.find(name.first);
+        int id2 = names.find(name.second);
+        EdgeNumber const* a = 0;
+        if (id1 >= 0 && id2 >= 0 && size_t(std::max(id1, id2)) < name2vertex.size()) {
+            VertexNumber v1 = name2vertex[id1];
+            VertexNumber v2 = name2vertex[id2];
+            if (v1 > v2) std::swap(v1, v2);
+            if (v1 > 0) a = edgeIndex.getValue(edgeKey(v1, v2));
+        }
+        if (a == 0) throw std::runtime_error(
                 "ERROR: " + name.first + "," + name.second + ": No such edge");
-        return found->second;
+        return *a - 1;
     }
 
     EdgeNumber getEdge(std::string const& name1,
@@ -537,7 +649,8 @@ public:
 
     std::pair<std::string,std::string> edgeName(EdgeNumber e) const {
         if (e < 0 || edgeSize() <= e) return std::make_pair("?", "?");
-        return edge2name[e];
+        return std::make_pair(names.name(edge2name[e].first),
+                names.name(edge2name[e].second));
     }
 
     std::string edgeLabel(EdgeNumber e) const {
@@ -561,13 +674,11 @@ public:
         assert(1 <= v1 && v1 <= vMax);
         assert(1 <= v2 && v2 <= vMax);
         if (v1 > v2) std::swap(v1, v2);
-        VertexNumberPair vp(v1, v2);
-        std::map<VertexNumberPair,EdgeNumber>::const_iterator found =
-                edgeIndex.find(vp);
-        if (found == edgeIndex.end()) throw std::runtime_error(
+        EdgeNumber const* a = edgeIndex.getValue(edgeKey(v1, v2));
+        if (a == 0) throw std::runtime_error(
                 "ERROR: (" + to_string(v1) + "," + to_string(v2)
                         + "): No such edge");
-        return found->second;
+        return *a - 1;
     }
 
     VertexNumber maxFrontierSize() const {
@@ -669,6 +780,13 @@ public:
     }
 
 private:
+    /*
+     * Key of an edge in edgeIndex, which stores edge numbers plus one.
+     */
+    static uint64_t edgeKey(VertexNumber v1, VertexNumber v2) {
+        return (uint64_t(v1) << 32) | uint64_t(v2);
+    }
+
     static std::string to_string(int i) {
         std::ostringstream oss;
         oss << i;
@@ -0,0 +1,145 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "ResourceUsage.hpp"
+
+namespace tdzdd {
+
+/**
+ * Memory limit for DD construction.
+ * The builder estimates its memory usage after each level from the node
+ * table and the pending states, on top of the resident set size at the
+ * start, and escalates as the usage approaches the limit:
+ * it sweeps dead nodes at every level from 60% of the limit,
+ * spills the states of pending lower levels to a temporary file
+ * from 80% if spilling is allowed, and aborts with MemoryBudgetExceeded
+ * when the limit is reached.
+ */
+class MemoryBudget {
+    size_t limit_;
+    bool spill_;
+
+public:
+    /**
+     * Constructor.
+     * @param limit the limit in bytes, or 0 for no limit.
+     * @param spill whether pending states may be written to a file,
+     *        which requires that the states of the spec are plain bytes
+     *        without pointers, as those of PodArrayDdSpec usually are.
+     */
+    explicit MemoryBudget(size_t limit = 0, bool spill = false)
+            : limit_(limit), spill_(spill) {
+    }
+
+    /**
+     * Gets the limit.
+     * @return the limit in bytes, or 0 for no limit.
+     */
+    size_t limit() const {
+        return limit_;
+    }
+
+    /**
+     * Checks whether spilling is allowed.
+     * @return true if pending states may be written to a file.
+     */
+    bool spill() const {
+        return spill_;
+    }
+
+    /**
+     * Gets the usage from which dead nodes are swept at every level.
+     * @return the usage in bytes.
+     */
+    size_t sweepThreshold() const {
+        return limit_ / 10 * 6;
+    }
+
+    /**
+     * Gets the usage from which pending states are spilled.
+     * @return the usage in bytes.
+     */
+    size_t spillThreshold() const {
+        return limit_ / 10 * 8;
+    }
+
+    /**
+     * Gets the current resident set size of the process.
+     * @return the size in bytes.
+     */
+    static size_t residentBytes() {
+#ifdef __linux__
+        std::FILE* fp = std::fopen("/proc/self/statm", "r");
+        if (fp) {
+            unsigned long size, resident;
+            int n = std::fscanf(fp, "%lu %lu", &size, &resident);
+            std::fclose(fp);
+            if (n == 2) return size_t(resident) * sysconf(_SC_PAGESIZE);
+        }
+#endif
+        return size_t(ResourceUsage().maxrss) * 1024;
+    }
+};
+
+/**
+ * Exception thrown when DD construction exceeds its memory budget.
+ */
+class MemoryBudgetExceeded: public std::runtime_error {
+    std::string report_;
+
+public:
+    /**
+     * Constructor.
+     * @param what the message.
+     * @param report the widths of the levels at the time of the abort.
+     */
+    MemoryBudgetExceeded(std::string const& what, std::string const& report)
+            : std::runtime_error(what), report_(report) {
+    }
+
+    ~MemoryBudgetExceeded() throw () {
+    }
+
+    /**
+     * Gets the widths of the levels at the time of the abort,
+     * one line "level nodes pending" for each nonempty level.
+     * @return the report.
+     */
+    std::string const& report() const {
+        return report_;
+    }
+};
+
+} // namespace tdzdd
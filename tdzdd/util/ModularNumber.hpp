@@ -0,0 +1,124 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <ostream>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace tdzdd {
+
+/**
+ * Integer modulo a prime number.
+ * Rational numbers whose denominators are not multiples of the modulus
+ * are represented exactly by their residues.
+ * @tparam MOD the prime modulus, which must be less than 2^31.
+ */
+template<uint32_t MOD = 998244353>
+class ModularNumber {
+    uint32_t val;
+
+public:
+    ModularNumber() :
+            val(0) {
+    }
+
+    ModularNumber(int64_t n) {
+        n %= int64_t(MOD);
+        val = (n < 0) ? n + MOD : n;
+    }
+
+    uint32_t value() const {
+        return val;
+    }
+
+    bool operator==(ModularNumber const& o) const {
+        return val == o.val;
+    }
+
+    bool operator!=(ModularNumber const& o) const {
+        return val != o.val;
+    }
+
+    ModularNumber& operator+=(ModularNumber const& o) {
+        val += o.val;
+        if (val >= MOD) val -= MOD;
+        return *this;
+    }
+
+    ModularNumber& operator-=(ModularNumber const& o) {
+        val = (val >= o.val) ? val - o.val : val + MOD - o.val;
+        return *this;
+    }
+
+    ModularNumber& operator*=(ModularNumber const& o) {
+        val = uint64_t(val) * o.val % MOD;
+        return *this;
+    }
+
+    ModularNumber& operator/=(ModularNumber const& o) {
+        return operator*=(o.inverse());
+    }
+
+    ModularNumber operator+(ModularNumber const& o) const {
+        return ModularNumber(*this) += o;
+    }
+
+    ModularNumber operator-(ModularNumber const& o) const {
+        return ModularNumber(*this) -= o;
+    }
+
+    ModularNumber operator*(ModularNumber const& o) const {
+        return ModularNumber(*this) *= o;
+    }
+
+    ModularNumber operator/(ModularNumber const& o) const {
+        return ModularNumber(*this) /= o;
+    }
+
+    /**
+     * Computes the multiplicative inverse.
+     * @return the inverse of this number.
+     */
+    ModularNumber inverse() const {
+        if (val == 0) throw std::runtime_error(
+                "ModularNumber: division by zero");
+
+        ModularNumber r(1);
+        ModularNumber x(*this);
+        for (uint32_t e = MOD - 2; e > 0; e >>= 1) {
+            if (e & 1) r *= x;
+            x *= x;
+        }
+        return r;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, ModularNumber const& o) {
+        return os << o.val;
+    }
+};
+
+} // namespace tdzdd
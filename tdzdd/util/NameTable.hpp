@@ -0,0 +1,199 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace tdzdd {
+
+/**
+ * Table of names that gives serial numbers to distinct names.
+ * Names are stored contiguously and looked up by open addressing.
+ * Decimal names without leading zeros are additionally cached
+ * in a direct-mapped array so that they are found without hashing.
+ */
+class NameTable {
+    static size_t const MAX_DECIMAL = 100000000;
+
+    std::vector<char> chars;     ///< Concatenation of all names.
+    std::vector<size_t> offset;  ///< Offsets of names in chars.
+    std::vector<int> slots;      ///< Hash table of name numbers.
+    std::vector<int> decimals;   ///< Name numbers of decimal names.
+
+    static size_t hash(char const* s, size_t len) {
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < len; ++i) {
+            h ^= static_cast<unsigned char>(s[i]);
+            h *= 1099511628211ULL;
+        }
+        return h ^ (h >> 29);
+    }
+
+    static bool decimalValue(char const* s, size_t len, size_t& k) {
+        if (len == 0 || len > 8 || (s[0] == '0' && len > 1)) return false;
+        k = 0;
+        for (size_t i = 0; i < len; ++i) {
+            if (s[i] < '0' || '9' < s[i]) return false;
+            k = k * 10 + (s[i] - '0');
+        }
+        return true;
+    }
+
+    bool equals(int id, char const* s, size_t len) const {
+        return offset[id + 1] - offset[id] == len
+                && std::memcmp(chars.data() + offset[id], s, len) == 0;
+    }
+
+    void rehash(size_t n) {
+        slots.assign(n, -1);
+        size_t const mask = n - 1;
+        for (int id = 0; id < size(); ++id) {
+            size_t i = hash(chars.data() + offset[id], offset[id + 1] - offset[id])
+                    & mask;
+            while (slots[i] >= 0) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = id;
+        }
+    }
+
+    void cacheDecimal(size_t k, int id) {
+        if (k >= decimals.size()) {
+            if (k >= MAX_DECIMAL || k >= 2 * decimals.size() + 65536) return;
+            decimals.resize(std::max(k + 1, 2 * decimals.size()), -1);
+        }
+        decimals[k] = id;
+    }
+
+public:
+    NameTable()
+            : offset(1, 0) {
+    }
+
+    /**
+     * Gets the number of names.
+     * @return the number of names.
+     */
+    int size() const {
+        return offset.size() - 1;
+    }
+
+    /**
+     * Removes all names.
+     */
+    void clear() {
+        chars.clear();
+        offset.assign(1, 0);
+        slots.clear();
+        decimals.clear();
+    }
+
+    /**
+     * Exchanges the contents with another table.
+     * @param o the other table.
+     */
+    void swap(NameTable& o) {
+        chars.swap(o.chars);
+        offset.swap(o.offset);
+        slots.swap(o.slots);
+        decimals.swap(o.decimals);
+    }
+
+    /**
+     * Finds a name.
+     * @param s pointer to the name.
+     * @param len length of the name.
+     * @return the number of the name or -1 if not found.
+     */
+    int find(char const* s, size_t len) const {
+        size_t k = 0;
+        if (decimalValue(s, len, k) && k < decimals.size() && decimals[k] >= 0) {
+            return decimals[k];
+        }
+        if (slots.empty()) return -1;
+
+        size_t const mask = slots.size() - 1;
+        for (size_t i = hash(s, len) & mask; slots[i] >= 0; i = (i + 1) & mask) {
+            if (equals(slots[i], s, len)) return slots[i];
+        }
+        return -1;
+    }
+
+    int find(std::string const& name) const {
+        return find(name.data(), name.size());
+    }
+
+    /**
+     * Finds a name and adds it if not found.
+     * @param s pointer to the name.
+     * @param len length of the name.
+     * @return the number of the name.
+     */
+    int intern(char const* s, size_t len) {
+        size_t k = 0;
+        bool const dec = decimalValue(s, len, k);
+        if (dec && k < decimals.size() && decimals[k] >= 0) {
+            return decimals[k];
+        }
+
+        if (size_t(size()) * 2 >= slots.size()) {
+            rehash(std::max(size_t(1024), slots.size() * 2));
+        }
+
+        size_t const mask = slots.size() - 1;
+        size_t i = hash(s, len) & mask;
+        for (; slots[i] >= 0; i = (i + 1) & mask) {
+            if (equals(slots[i], s, len)) return slots[i];
+        }
+
+        int const id = size();
+        chars.insert(chars.end(), s, s + len);
+        offset.push_back(chars.size());
+        slots[i] = id;
+        if (dec) cacheDecimal(k, id);
+        return id;
+    }
+
+    int intern(std::string const& name) {
+        return intern(name.data(), name.size());
+    }
+
+    /**
+     * Gets a name.
+     * @param id the number of the name.
+     * @return the name.
+     */
+    std::string name(int id) const {
+        return std::string(chars.begin() + offset[id],
+                chars.begin() + offset[id + 1]);
+    }
+};
+
+} // namespace tdzdd
@@ -0,0 +1,203 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ResourceUsage.hpp"
+
+namespace tdzdd {
+
+/**
+ * Per-level statistics of DD construction and reduction.
+ * Recording is disabled by default and costs one test per level then.
+ * Once enabled, DdBuilder, DdBuilderMP and DdReducer add a record
+ * for every level they process, and DdSweeper adds one for every sweep.
+ */
+class RunStatistics {
+public:
+    /**
+     * Metrics of one level in one phase.
+     */
+    struct Level {
+        std::string phase;  ///< "build", "build_mp", "reduce" or "sweep".
+        int level;          ///< Level.
+        size_t generated;   ///< Number of incoming states or nodes.
+        size_t unique;      ///< Number of distinct states or nodes.
+        size_t merged;      ///< Number of states or nodes merged into others.
+        size_t dead;        ///< Number of dead or deleted nodes.
+        size_t nodes;       ///< Number of nodes produced at the level.
+        size_t tableSize;   ///< Total size of the hash tables used.
+        size_t collisions;  ///< Total number of hash-table collisions.
+        double seconds;     ///< Elapsed time for the level.
+        long maxrss;        ///< Maximum resident set size in kilobytes.
+
+        Level(std::string const& phase, int level)
+                : phase(phase), level(level), generated(0), unique(0),
+                  merged(0), dead(0), nodes(0), tableSize(0), collisions(0),
+                  seconds(0), maxrss(0) {
+        }
+
+        /**
+         * Returns the load factor of the hash tables.
+         * @return the number of distinct entries per table slot.
+         */
+        double load() const {
+            return tableSize ? double(unique) / tableSize : 0.0;
+        }
+    };
+
+private:
+    struct State {
+        bool enabled;
+        std::vector<Level> levels;
+
+        State()
+                : enabled(false) {
+        }
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+public:
+    /**
+     * Turns recording on or off.
+     * @param flag true to record.
+     * @return the previous setting.
+     */
+    static bool enable(bool flag = true) {
+        bool prev = state().enabled;
+        state().enabled = flag;
+        return prev;
+    }
+
+    /**
+     * Checks whether recording is on.
+     * @return true if recording is on.
+     */
+    static bool enabled() {
+        return state().enabled;
+    }
+
+    /**
+     * Adds a record.
+     * The elapsed time and the resident set size are taken here.
+     * @param rec the record.
+     * @param startTime wall clock time when the level started.
+     */
+    static void record(Level rec, double startTime) {
+        rec.seconds = getWallClockTime() - startTime;
+        rec.maxrss = ResourceUsage().maxrss;
+#ifdef _OPENMP
+#pragma omp critical(tdzdd_RunStatistics)
+#endif
+        state().levels.push_back(rec);
+    }
+
+    /**
+     * Returns all the records in the order they were added.
+     * @return the records.
+     */
+    static std::vector<Level> const& levels() {
+        return state().levels;
+    }
+
+    /**
+     * Discards all the records.
+     */
+    static void clear() {
+        state().levels.clear();
+    }
+
+    /**
+     * Writes the records as a JSON array of objects.
+     * @param os the output stream.
+     */
+    static void writeJson(std::ostream& os) {
+        std::vector<Level> const& v = levels();
+        os << "[\n";
+        for (size_t k = 0; k < v.size(); ++k) {
+            Level const& r = v[k];
+            os << "  {\"phase\":\"" << r.phase << "\",\"level\":" << r.level
+               << ",\"generated\":" << r.generated << ",\"unique\":"
+               << r.unique << ",\"merged\":" << r.merged << ",\"dead\":"
+               << r.dead << ",\"nodes\":" << r.nodes << ",\"table_size\":"
+               << r.tableSize << ",\"load\":" << r.load()
+               << ",\"collisions\":" << r.collisions << ",\"seconds\":"
+               << r.seconds << ",\"maxrss_kb\":" << r.maxrss << "}"
+               << (k + 1 < v.size() ? ",\n" : "\n");
+        }
+        os << "]\n";
+    }
+
+    /**
+     * Writes the records as CSV with a header line.
+     * @param os the output stream.
+     */
+    static void writeCsv(std::ostream& os) {
+        std::vector<Level> const& v = levels();
+        os << "phase,level,generated,unique,merged,dead,nodes,table_size,"
+           "load,collisions,seconds,maxrss_kb\n";
+        for (size_t k = 0; k < v.size(); ++k) {
+            Level const& r = v[k];
+            os << r.phase << "," << r.level << "," << r.generated << ","
+               << r.unique << "," << r.merged << "," << r.dead << ","
+               << r.nodes << "," << r.tableSize << "," << r.load() << ","
+               << r.collisions << "," << r.seconds << "," << r.maxrss << "\n";
+        }
+    }
+
+    /**
+     * Writes the records to a file.
+     * The format is CSV if the file name ends with ".csv",
+     * or JSON otherwise.
+     * @param filename the file name.
+     */
+    static void write(std::string const& filename) {
+        std::ofstream fout(filename.c_str());
+        if (!fout) {
+            throw std::runtime_error("ERROR: " + filename + ": Cannot open");
+        }
+        fout << std::setprecision(6);
+        std::string::size_type n = filename.size();
+        if (n >= 4 && filename.compare(n - 4, 4, ".csv") == 0) {
+            writeCsv(fout);
+        }
+        else {
+            writeJson(fout);
+        }
+    }
+};
+
+} // namespace tdzdd
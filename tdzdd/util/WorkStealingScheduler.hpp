@@ -0,0 +1,163 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace tdzdd {
+
+/**
+ * Work-stealing scheduler of a parallel loop over [0, n).
+ * Each thread starts with an equal contiguous part of the range and
+ * takes chunks from the front of its own part.
+ * A thread that has run out of work steals the latter half of the
+ * remaining part of another thread, so that the iterations of uneven
+ * cost are balanced without a shared counter, and each thread works
+ * mostly on consecutive iterations.
+ *
+ * The range is set by reset() outside of the loop, and then each thread
+ * calls next() with its thread number until it returns false.
+ * The threads must synchronize before the range is reset again.
+ */
+class WorkStealingScheduler {
+    struct Part {
+        size_t begin;
+        size_t end;
+#ifdef _OPENMP
+        omp_lock_t lock;
+#endif
+        char padding[64]; ///< keeps the parts on separate cache lines.
+    };
+
+    int const threads;
+    Part* const parts;
+    size_t chunk;
+
+    WorkStealingScheduler(WorkStealingScheduler const&);
+    WorkStealingScheduler& operator=(WorkStealingScheduler const&);
+
+public:
+    /**
+     * Constructor.
+     * @param threads the number of threads.
+     */
+    explicit WorkStealingScheduler(int threads) :
+            threads(std::max(threads, 1)), parts(new Part[this->threads]),
+            chunk(1) {
+        for (int y = 0; y < this->threads; ++y) {
+            parts[y].begin = parts[y].end = 0;
+#ifdef _OPENMP
+            omp_init_lock(&parts[y].lock);
+#endif
+        }
+    }
+
+    ~WorkStealingScheduler() {
+#ifdef _OPENMP
+        for (int y = 0; y < threads; ++y) {
+            omp_destroy_lock(&parts[y].lock);
+        }
+#endif
+        delete[] parts;
+    }
+
+    /**
+     * Sets the range of the loop.
+     * @param n the number of iterations.
+     * @param grain the number of iterations taken at a time,
+     *        or 0 to choose it from the number of iterations per thread.
+     */
+    void reset(size_t n, size_t grain = 0) {
+        chunk = (grain > 0) ? grain : 1 + n / (size_t(threads) * 64);
+        for (int y = 0; y < threads; ++y) {
+            parts[y].begin = n * y / threads;
+            parts[y].end = n * (y + 1) / threads;
+        }
+    }
+
+    /**
+     * Gets the next chunk of iterations for a thread.
+     * @param y the thread number.
+     * @param begin the first iteration of the chunk.
+     * @param end the iteration following the chunk.
+     * @return false if no iterations are left.
+     */
+    bool next(int y, size_t& begin, size_t& end) {
+        for (;;) {
+            if (take(parts[y], begin, end)) return true;
+
+            size_t b = 0;
+            size_t e = 0;
+            for (int k = 1; k < threads && b == e; ++k) {
+                steal(parts[(y + k) % threads], b, e);
+            }
+            if (b == e) return false;
+
+            lock(parts[y]);
+            parts[y].begin = b;
+            parts[y].end = e;
+            unlock(parts[y]);
+        }
+    }
+
+private:
+    static void lock(Part& part) {
+#ifdef _OPENMP
+        omp_set_lock(&part.lock);
+#endif
+    }
+
+    static void unlock(Part& part) {
+#ifdef _OPENMP
+        omp_unset_lock(&part.lock);
+#endif
+    }
+
+    bool take(Part& part, size_t& begin, size_t& end) {
+        lock(part);
+        begin = part.begin;
+        end = std::min(part.begin + chunk, part.end);
+        part.begin = end;
+        unlock(part);
+        return begin < end;
+    }
+
+    void steal(Part& part, size_t& begin, size_t& end) {
+        lock(part);
+        size_t const rest = part.end - part.begin;
+        begin = (rest <= chunk) ? part.begin : part.begin + rest / 2;
+        end = part.end;
+        part.end = begin;
+        unlock(part);
+    }
+};
+
+} // namespace tdzdd